@@ -4,6 +4,26 @@
 #include <filesystem>
 #include <vector>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <deque>
+#include <unordered_map>
+#include <exception>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <initializer_list>
 
 /**
 * The baselib namespace provides classes with algorithms for use in many problems
@@ -13,6 +33,624 @@ namespace baselib{
 	class AlgorithmException : public std::exception { };
 	class WrongFileFormatException : public AlgorithmException { };
 	class NoSolutionException : public AlgorithmException { };
+	class TimeoutException : public AlgorithmException { };
+
+	/**
+	* Bounded multi-producer multi-consumer lock-free queue (ring buffer with a sequence number per cell).
+	* The capacity is rounded up to a power of two. Blocking operations retry a few times, then sleep on an eventcount
+	* until another thread pushes, pops or closes the queue, so idle threads neither burn the CPU nor wake up late.
+	* @tparam T The type of elements, should be cheap to copy (for example a pointer).
+	*/
+	template <typename T>
+	class BoundedQueue {
+	private:
+		// Failed attempts of a blocking operation, each yielding the thread, before it goes to sleep
+		static constexpr int spinAttempts = 64;
+
+		struct Cell {
+			std::atomic<std::size_t> sequence;
+			T data;
+		};
+		std::unique_ptr<Cell[]> buffer;
+		std::size_t mask;
+		alignas(64) std::atomic<std::size_t> enqueuePosition;
+		alignas(64) std::atomic<std::size_t> dequeuePosition;
+		std::atomic<bool> closed;
+
+		// Eventcount: every change of the queue increments the epoch and wakes the sleeping threads, if there are any
+		alignas(64) std::atomic<std::uint32_t> epoch;
+		std::atomic<int> sleeping;
+		std::mutex sleepMutex;
+		std::condition_variable changed;
+
+		inline void notify()
+		{
+			epoch.fetch_add(1, std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_seq_cst) > 0) {
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				changed.notify_all();
+			}
+		}
+		/**
+		* Waits until the operation succeeds, calling it again after every change of the queue.
+		* @param attempt Returns true when the operation succeeded or cannot succeed anymore.
+		*/
+		template <typename Attempt>
+		void waitUntil(Attempt attempt)
+		{
+			for (int spin = 0; spin < spinAttempts; spin++) {
+				if (attempt()) return;
+				std::this_thread::yield();
+			}
+			while (true) {
+				sleeping.fetch_add(1, std::memory_order_seq_cst);
+				std::uint32_t seen = epoch.load(std::memory_order_seq_cst);
+				// Tried again after announcing the sleep, so a change made in the meantime is not missed
+				bool done = attempt();
+				if (!done) {
+					std::unique_lock<std::mutex> lock(sleepMutex);
+					changed.wait(lock, [this, seen]() { return epoch.load(std::memory_order_seq_cst) != seen; });
+				}
+				sleeping.fetch_sub(1, std::memory_order_seq_cst);
+				if (done) return;
+			}
+		}
+	public:
+		BoundedQueue(std::size_t capacity) : enqueuePosition(0), dequeuePosition(0), closed(false), epoch(0), sleeping(0)
+		{
+			std::size_t size = 2;
+			while (size < capacity) size *= 2;
+			buffer.reset(new Cell[size]);
+			mask = size - 1;
+			for (std::size_t i = 0; i < size; i++) buffer[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		/**
+		* Adds the element if the queue is not full.
+		* @return false if the queue is full.
+		*/
+		bool tryPush(const T& value)
+		{
+			std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& cell = buffer[position & mask];
+				std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+				std::intptr_t difference = (std::intptr_t)sequence - (std::intptr_t)position;
+				if (difference == 0) {
+					if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.data = value;
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0) return false;
+				else position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		/**
+		* Takes the oldest element if the queue is not empty.
+		* @return false if the queue is empty.
+		*/
+		bool tryPop(T& value)
+		{
+			std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& cell = buffer[position & mask];
+				std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+				std::intptr_t difference = (std::intptr_t)sequence - (std::intptr_t)(position + 1);
+				if (difference == 0) {
+					if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						value = cell.data;
+						cell.sequence.store(position + mask + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0) return false;
+				else position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		/**
+		* Adds the element, waiting while the queue is full.
+		*/
+		void push(const T& value)
+		{
+			waitUntil([&]() { return tryPush(value); });
+			notify();
+		}
+		/**
+		* Takes the oldest element, waiting while the queue is empty.
+		* @return false if the queue is empty and closed.
+		*/
+		bool pop(T& value)
+		{
+			bool found = false;
+			waitUntil([&]() {
+				if (tryPop(value)) found = true;
+				else if (closed.load(std::memory_order_acquire)) found = tryPop(value);
+				else return false;
+				return true;
+			});
+			if (found) notify();
+			return found;
+		}
+		/**
+		* Marks that no more elements will be added. Wakes the threads waiting in pop.
+		*/
+		inline void close()
+		{
+			closed.store(true, std::memory_order_release);
+			notify();
+		}
+	};
+
+	/**
+	* Executes tasks in three stages: one reader thread, a pool of solver threads and a writer running on the calling thread.
+	* The stages are connected by bounded lock-free queues. At most `capacity` tasks are in progress at once,
+	* so a slow writer stops the reader. The writer receives the tasks in the order they were read.
+	* The stage functions must not throw.
+	* @tparam Task State of one task. Task objects are reused for subsequent tasks.
+	*/
+	template <typename Task>
+	class Pipeline {
+	private:
+		struct Slot {
+			std::size_t sequence;
+			Task task;
+		};
+		int workers;
+		std::size_t capacity;
+	public:
+		/**
+		* @param workers Number of solver threads.
+		* @param capacity Maximal number of tasks in progress.
+		*/
+		Pipeline(int workers, std::size_t capacity) : workers(std::max(1, workers)), capacity(std::max<std::size_t>(1, capacity)) { }
+
+		/**
+		* Runs the pipeline until the reader reports that there are no more tasks.
+		* @param read Called by the reader thread as bool(Task&). Fills the task and returns true, or returns false at the end of input.
+		* @param solve Called by solver threads as void(int worker, Task&).
+		* @param write Called on the calling thread as void(Task&), in the order of reading.
+		*/
+		template <typename Read, typename Solve, typename Write>
+		void run(Read read, Solve solve, Write write)
+		{
+			std::vector<Slot> slots(capacity);
+			BoundedQueue<Slot*> freeSlots(capacity);
+			BoundedQueue<Slot*> toSolve(capacity);
+			BoundedQueue<Slot*> solved(capacity);
+			for (Slot& slot : slots) freeSlots.push(&slot);
+
+			std::thread reader([&]() {
+				std::size_t sequence = 0;
+				Slot* slot;
+				while (freeSlots.pop(slot)) {
+					if (!read(slot->task)) break;
+					slot->sequence = sequence++;
+					toSolve.push(slot);
+				}
+				toSolve.close();
+			});
+
+			// The last solver to finish closes the queue of solved tasks, which ends the writer
+			std::atomic<int> running = workers;
+			std::vector<std::thread> solvers;
+			for (int worker = 0; worker < workers; worker++) {
+				solvers.emplace_back([&, worker]() {
+					Slot* slot;
+					while (toSolve.pop(slot)) {
+						solve(worker, slot->task);
+						solved.push(slot);
+					}
+					if (--running == 0) solved.close();
+				});
+			}
+
+			// Tasks solved out of order wait here, each slot index is unique among the tasks in progress
+			std::vector<Slot*> pending(capacity, nullptr);
+			std::size_t next = 0;
+			Slot* slot;
+			while (solved.pop(slot)) {
+				pending[slot->sequence % capacity] = slot;
+				while ((slot = pending[next % capacity]) != nullptr && slot->sequence == next) {
+					write(slot->task);
+					pending[next % capacity] = nullptr;
+					freeSlots.push(slot);
+					next++;
+				}
+			}
+
+			reader.join();
+			for (auto& solver : solvers) solver.join();
+		}
+	};
+
+	/**
+	* Region-based allocator. Objects are placed one after another in large blocks and are all released together by reset().
+	* The blocks are kept after reset, so a solver that allocates the same amount of memory for every file
+	* reaches a state in which it does not call the system allocator at all.
+	*/
+	class Arena {
+	private:
+		struct Block {
+			char* data;
+			std::size_t size;
+		};
+		std::vector<Block> blocks;
+		std::size_t blockSize;
+		std::size_t currentBlock;
+		std::size_t used;
+		std::vector<std::pair<void*, void(*)(void*)>> destructors;
+	public:
+		/**
+		* @param blockSize The default size of the block in bytes. Larger allocations get a block of their own size.
+		*/
+		Arena(std::size_t blockSize = 1 << 16);
+		~Arena();
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		/**
+		* Returns uninitialized memory of the given size and alignment, valid until the next reset.
+		*/
+		void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+		/**
+		* Constructs the object in the arena. Its destructor is called by reset.
+		*/
+		template <typename T, typename... Args>
+		T* create(Args&&... args)
+		{
+			T* result = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				destructors.emplace_back(result, [](void* p) { static_cast<T*>(p)->~T(); });
+			}
+			return result;
+		}
+		/**
+		* Constructs an array of default initialized objects in the arena. Their destructors are called by reset.
+		*/
+		template <typename T>
+		T* createArray(std::size_t count)
+		{
+			T* result = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+			for (std::size_t i = 0; i < count; i++) {
+				new (result + i) T;
+				if constexpr (!std::is_trivially_destructible_v<T>) {
+					destructors.emplace_back(result + i, [](void* p) { static_cast<T*>(p)->~T(); });
+				}
+			}
+			return result;
+		}
+
+		/**
+		* Calls the destructors of the created objects in reverse order and makes all the memory available again.
+		*/
+		void reset();
+		/**
+		* Returns the number of bytes reserved from the system allocator.
+		*/
+		std::size_t capacity() const;
+	};
+
+	/**
+	* Read-only view of a whole file. On POSIX systems the file is memory-mapped, elsewhere it is read into a buffer.
+	*/
+	class MappedFile {
+	private:
+		const char* data;
+		std::size_t size;
+		void* mapping;
+		std::string buffer;
+	public:
+		MappedFile(const std::string& path);
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		* Checks if the file was opened successfully
+		*/
+		inline bool isOpen() const { return data != nullptr; }
+		/**
+		* Returns the content of the file. Valid as long as the object exists.
+		*/
+		inline std::string_view view() const { return std::string_view(data, size); }
+	};
+
+	/**
+	* Results of solved puzzles stored on disk, addressed by the hash of the algorithm, its version and the puzzle text.
+	* The file is an append-only log of entries, mapped and indexed in memory when the cache is opened.
+	* Entries added later are kept in memory and appended to the file. All methods are thread-safe.
+	*/
+	class SolutionCache {
+	public:
+		/**
+		* 128-bit hash identifying a puzzle of an algorithm
+		*/
+		struct Key {
+			std::uint64_t low;
+			std::uint64_t high;
+			inline bool operator==(const Key& other) const { return low == other.low && high == other.high; }
+		};
+	private:
+		struct KeyHash {
+			inline std::size_t operator()(const Key& key) const { return (std::size_t)key.low; }
+		};
+
+		std::unique_ptr<MappedFile> mapped;
+		std::unordered_map<Key, std::string_view, KeyHash> index;
+		// Results added since the file was opened, the deque keeps their addresses stable
+		std::deque<std::string> added;
+		std::ofstream log;
+		std::mutex mutex;
+		std::atomic<std::uint64_t> hits;
+		std::atomic<std::uint64_t> misses;
+
+		/**
+		* Adds the entries of the mapped file to the index, until the end of the file or the first incomplete entry.
+		* @return Size of the file up to the end of the last complete entry.
+		*/
+		std::size_t indexEntries();
+	public:
+		/**
+		* Opens the cache file, creating it if it does not exist. A damaged entry at the end of the file, left by an interrupted write, is removed.
+		* @throws std::runtime_error When the file cannot be opened or is not a cache file.
+		*/
+		SolutionCache(const std::string& path);
+		SolutionCache(const SolutionCache&) = delete;
+		SolutionCache& operator=(const SolutionCache&) = delete;
+
+		/**
+		* Computes the key of the puzzle. Empty lines and line endings do not change the key, the other characters do.
+		*/
+		static Key keyOf(const std::string& algorithm, int version, std::string_view puzzle);
+
+		/**
+		* Looks up the result and counts a hit or a miss.
+		* @param result Receives the stored result, valid as long as the cache exists.
+		*/
+		bool find(const Key& key, std::string_view& result);
+		/**
+		* Stores the result, unless the key is already stored.
+		*/
+		void store(const Key& key, std::string_view result);
+
+		inline std::uint64_t getHits() const { return hits.load(); }
+		inline std::uint64_t getMisses() const { return misses.load(); }
+		std::size_t size();
+	};
+
+	/**
+	* Splits text into lines without copying it. The text is either kept in memory (for example a MappedFile)
+	* or read from a stream line by line, in which case only the current line or group of lines is buffered.
+	*/
+	class TextReader {
+	private:
+		std::string_view text;
+		std::size_t position;
+		std::istream* stream;
+		std::string line;
+		std::string group;
+		const char* groupBegin;
+		const char* groupEnd;
+	public:
+		TextReader(std::string_view text);
+		TextReader(std::istream& stream);
+
+		/**
+		* Reads the next line without the line break ('\n' or "\r\n").
+		* For a stream the view is valid until the next call.
+		* @return false if there are no more lines.
+		*/
+		bool readLine(std::string_view& result);
+		/**
+		* Returns all the remaining text.
+		*/
+		std::string_view readAll();
+
+		/**
+		* Starts collecting a group of lines, for example the lines of one puzzle.
+		*/
+		void startGroup();
+		/**
+		* Adds the line returned by the last readLine call to the group.
+		*/
+		void addToGroup(std::string_view line);
+		/**
+		* Returns the lines added to the group. For text in memory it is a part of the text, for a stream a copy of the lines.
+		* Valid until the next startGroup call.
+		*/
+		std::string_view getGroup() const;
+		/**
+		* Whether the text is read from a stream, so views returned by the reader are only valid until the next call.
+		*/
+		inline bool isStream() const { return stream != nullptr; }
+	};
+
+	/**
+	* Deadline of a single puzzle, checked cooperatively by the solver loops.
+	* check() is cheap: only every checkInterval calls it reads the clock and the cancel flag. It suits loops with short iterations,
+	* like the nodes of a search. Loops whose single iteration does a lot of work, like a pass over the whole board, call checkNow().
+	*/
+	class CancellationToken {
+	public:
+		static constexpr int checkInterval = 1024;
+	private:
+		std::chrono::steady_clock::time_point deadline;
+		std::atomic<bool> cancelled;
+		int countdown;
+
+		/**
+		* Throws TimeoutException if the token was cancelled or the deadline has passed.
+		*/
+		void poll();
+	public:
+		CancellationToken();
+
+		/**
+		* Starts a new puzzle with the given time limit. Zero means no limit.
+		*/
+		void start(std::chrono::nanoseconds timeout);
+		/**
+		* Cancels the current puzzle, can be called from another thread. The next poll throws TimeoutException.
+		*/
+		inline void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+		/**
+		* Throws TimeoutException if the puzzle was cancelled or its deadline has passed.
+		* Call it in every loop of a solver that may run for long.
+		*/
+		inline void check()
+		{
+			if (--countdown <= 0) poll();
+		}
+		/**
+		* Same as check(), but reads the clock and the cancel flag right away.
+		*/
+		inline void checkNow() { poll(); }
+	};
+
+	/**
+	* Event counter for instrumenting solvers. Without BASELIB_STATS defined all operations are empty and compile to nothing.
+	* Counters are not synchronized, each thread should count in its own instance of the algorithm.
+	*/
+	class Counter {
+#ifdef BASELIB_STATS
+	private:
+		std::uint64_t value = 0;
+	public:
+		static constexpr bool enabled = true;
+		inline void operator++() { value++; }
+		inline void add(std::uint64_t amount) { value += amount; }
+		inline std::uint64_t get() const { return value; }
+		inline void reset() { value = 0; }
+#else
+	public:
+		static constexpr bool enabled = false;
+		inline void operator++() { }
+		inline void add(std::uint64_t) { }
+		inline std::uint64_t get() const { return 0; }
+		inline void reset() { }
+#endif
+	};
+
+	/**
+	* Named counters of one algorithm instance. Instances of the same algorithm register their counters in the same order,
+	* so values can be summed by position.
+	*/
+	class CounterRegistry {
+	private:
+		std::vector<const char*> names;
+		std::vector<Counter*> counters;
+	public:
+		/**
+		* Registers the counter under the name. The counter must outlive the registry.
+		*/
+		void add(const char* name, Counter& counter);
+		inline int size() const { return (int)counters.size(); }
+		inline const char* nameOf(int i) const { return names[i]; }
+		inline std::uint64_t valueOf(int i) const { return counters[i]->get(); }
+		/**
+		* Sets all counters to 0.
+		*/
+		void reset();
+		/**
+		* Adds the values of the counters to the totals, resizing them if needed.
+		*/
+		void addTo(std::vector<std::uint64_t>& totals) const;
+		/**
+		* Prints the counters as "name=value" pairs separated with commas.
+		* @param values Values to print instead of the current ones, for example totals collected with addTo.
+		*/
+		void print(std::ostream& o, const std::vector<std::uint64_t>* values = nullptr) const;
+	};
+
+	/**
+	* Histogram of non-negative values (latencies in nanoseconds) with a bounded relative error, like the HDR histogram.
+	* Values below 2^precisionBits are counted exactly, larger ones in buckets of width 2^-(precisionBits-1) of the value.
+	*/
+	class LatencyHistogram {
+	public:
+		static constexpr int precisionBits = 7;
+	private:
+		static constexpr int linearBuckets = 1 << precisionBits;
+		static constexpr int halfBuckets = linearBuckets / 2;
+		// Values from 2^precisionBits to 2^64 - 1 span 64 - precisionBits powers of two, each split into halfBuckets
+		static constexpr int bucketCount = linearBuckets + (64 - precisionBits) * halfBuckets;
+
+		std::vector<std::uint64_t> counts;
+		std::uint64_t total;
+		std::uint64_t minimum;
+		std::uint64_t maximum;
+		long double sum;
+
+		static int bucketOf(std::uint64_t value);
+		static std::uint64_t upperBound(int bucket);
+	public:
+		LatencyHistogram();
+
+		void record(std::uint64_t value);
+		/**
+		* Adds all values recorded in the other histogram.
+		*/
+		void merge(const LatencyHistogram& other);
+		void clear();
+
+		inline std::uint64_t count() const { return total; }
+		inline std::uint64_t min() const { return total > 0 ? minimum : 0; }
+		inline std::uint64_t max() const { return maximum; }
+		inline double mean() const { return total > 0 ? (double)(sum / total) : 0; }
+		/**
+		* Returns the value below or equal to which the given percent of recorded values are, within the precision of the buckets.
+		* @param percent Percentile from 0 to 100.
+		*/
+		std::uint64_t percentile(double percent) const;
+	};
+
+	/**
+	* Outcome of processing a single puzzle.
+	*/
+	enum class Outcome { SOLVED, NO_SOLUTION, WRONG_FORMAT, TIMEOUT, FAILED, COUNT };
+
+	/**
+	* Latencies of the puzzles processed in a run, by outcome, and the wall time of the run.
+	*/
+	class RunSummary {
+	private:
+		LatencyHistogram latencies[(int)Outcome::COUNT];
+		std::chrono::steady_clock::time_point startTime;
+		std::uint64_t wallTime;
+	public:
+		RunSummary();
+
+		/**
+		* Clears recorded latencies and starts measuring the wall time.
+		*/
+		void start();
+		/**
+		* Stops measuring the wall time.
+		*/
+		void stop();
+		/**
+		* Records the latency of a puzzle in nanoseconds.
+		*/
+		inline void record(Outcome outcome, std::uint64_t nanoseconds) { latencies[(int)outcome].record(nanoseconds); }
+		/**
+		* Returns latencies of all puzzles.
+		*/
+		LatencyHistogram total() const;
+		inline const LatencyHistogram& of(Outcome outcome) const { return latencies[(int)outcome]; }
+		static const char* nameOf(Outcome outcome);
+
+		/**
+		* Prints the number of puzzles, throughput and latency percentiles in human readable form.
+		*/
+		void print(std::ostream& o) const;
+		/**
+		* Prints the same summary as a JSON object. Latencies are in nanoseconds.
+		*/
+		void printJson(std::ostream& o) const;
+	};
 
 	/**
 	* Base class for algorithms solving specific problems
@@ -21,126 +659,657 @@ namespace baselib{
 	private:
 		std::string input;
 		std::string output;
+		bool batch;
+		std::string summaryPath;
+		RunSummary summary;
+		bool stats;
+		std::chrono::nanoseconds timeout;
+		std::shared_ptr<SolutionCache> cache;
+		// Sum of the counters of all puzzles in the run
+		std::vector<std::uint64_t> counterTotals;
 	public:
 		PuzzleAlgorithm();
 		virtual ~PuzzleAlgorithm();
 
 		/**
-		* Sets the path to the input directory.
-		* The substring "<alg_name>" will be replaced in the runAlgorithm() method by the algorithm name
+		* Sets the path to the input directory.
+		* The substring "<alg_name>" will be replaced in the runAlgorithm() method by the algorithm name
+		* The value "-" means the standard input, which is read as a stream of many puzzles.
+		*/
+		void setInput(std::string value);
+		/**
+		* Sets the path to the output directory.
+		* The substring "<alg_name>" will be replaced in the runAlgorithm() method by the algorithm name
+		* The value "-" means the standard output. Progress messages are then written to the error output.
+		*/
+		void setOutput(std::string value);
+		/**
+		* Enables the batch mode, in which each input file contains many puzzles read with nextPuzzle().
+		* The results are written to a single output file in the same order, separated by empty lines.
+		*/
+		void setBatch(bool value);
+		/**
+		* Sets the path of a file to which runAlgorithm() writes the summary of the run as JSON. Empty means no file.
+		*/
+		void setSummaryPath(std::string value);
+		/**
+		* Enables printing the counters of the algorithm after each puzzle and their totals at the end of runAlgorithm().
+		* Counters are only collected when the program is compiled with BASELIB_STATS.
+		*/
+		void setStats(bool value);
+		/**
+		* Sets the time limit for solving a single puzzle. Puzzles exceeding it fail with TimeoutException. Zero means no limit.
+		*/
+		void setTimeout(std::chrono::nanoseconds value);
+		/**
+		* Sets the cache of solved puzzles. Puzzles found in it are not solved again, newly solved ones are stored. nullptr disables caching.
+		*/
+		void setCache(std::shared_ptr<SolutionCache> value);
+		std::shared_ptr<SolutionCache> getCache() const;
+
+		/**
+		* Run the algorithm for each file in the input folder
+		* @param measureTime Whether to print the solving time of each file and the summary of puzzle latencies at the end.
+		* @param jobs Number of solver threads. With more than one, puzzles go through a Pipeline: a reader thread opens the files and parses the puzzles,
+		*	solver threads solve them and the calling thread formats and writes the results in the input order. 0 means one per hardware thread.
+		*/
+		void runAlgorithm(bool measureTime, int jobs = 1);
+		/**
+		* Returns latencies of the puzzles processed in the last runAlgorithm().
+		*/
+		const RunSummary& getSummary() const;
+
+		/**
+		* Creates a new, independent instance of the same algorithm. Used to give each worker thread its own solver state.
+		*/
+		virtual std::shared_ptr<PuzzleAlgorithm> clone() const = 0;
+
+		virtual std::string getName();
+		/**
+		* Returns the version of the solver, part of the keys in the SolutionCache.
+		* Increase it whenever the results of the algorithm change, so stale cached results are not used.
+		*/
+		virtual int getVersion();
+		/**
+		* Selects the solving engine, for algorithms having more than one.
+		* @return false if the algorithm has no engine with this name.
+		*/
+		virtual bool setEngine(const std::string& name);
+		/**
+		* Prints the format for the user that the input file should have to be handled by the algorithm
+		*/
+		virtual void printFormat(std::ostream& o);
+		/**
+		* Reads the text of the next puzzle from a text with many puzzles.
+		* By default puzzles are groups of non-empty lines separated by one or more empty lines.
+		* @param in Reader of the text with puzzles.
+		* @param puzzle Receives the text of the puzzle, in the format accepted by processFile. Valid until the next call.
+		* @return false if there are no more puzzles in the text.
+		*/
+		virtual bool nextPuzzle(TextReader& in, std::string_view& puzzle);
+		/**
+		* Solves a single puzzle and writes the result, or the reason of the failure as in batch mode, to out.
+		* @return The outcome of the puzzle.
+		*/
+		Outcome solvePuzzle(std::string_view puzzle, std::ostream& out);
+	protected:
+		/**
+		* Memory for the state of the currently processed file. It is reset after cleanUp().
+		*/
+		Arena arena;
+		/**
+		* Counters of the algorithm. They are printed and reset after each puzzle.
+		*/
+		CounterRegistry counters;
+		/**
+		* Deadline of the current puzzle. Solvers should call cancellation.check() in their loops.
+		*/
+		CancellationToken cancellation;
+
+		/**
+		* Reads the problem from the text. It processes it, then writes the result to the output stream.
+		* By default it runs parse(), solve() and format() one after another.
+		* 
+		* @param input
+		*	text of the problem, usually a view of a memory-mapped file. Parse it in place, it is valid until the function returns
+		* @param outFile
+		*	stream for saving results
+		*/
+		virtual void processFile(std::string_view input, std::ostream& outFile);
+		/**
+		* Reads the problem from the text into the state of the algorithm. Throws WrongFileFormatException for invalid text.
+		* @param input Text of the problem, valid until format() returns.
+		*/
+		virtual void parse(std::string_view input) = 0;
+		/**
+		* Solves the parsed problem. May throw NoSolutionException.
+		*/
+		virtual void solve() = 0;
+		/**
+		* Writes the result of solve() to the output stream.
+		*/
+		virtual void format(std::ostream& outFile) = 0;
+		/**
+		* Returns whether the last solve() completed the solution. Only results of solved puzzles are stored in the cache,
+		* so a partial result is computed again by a newer version of the solver. By default every result is complete.
+		*/
+		virtual bool isSolved();
+		/**
+		* The function is always called after processFile, or after the last phase run for a puzzle.
+		* It should be used to free variables before running the algorithm for the next file.
+		* Objects created in the arena are released right after it returns.
+		*/
+		virtual void cleanUp() = 0;
+	private:
+		/**
+		* Processes the puzzles read from the standard input.
+		*/
+		void processInput(bool measureTime, int jobs, const std::string& outputDir, std::ostream& log);
+		/**
+		* Processes all files in the input directory.
+		*/
+		void processDirectory(const std::string& inputDir, bool measureTime, int jobs, const std::string& outputDir, std::ostream& log);
+		/**
+		* Opens the input file and the output file of the same name in the output directory, then processes the file.
+		* @param out Stream for results used instead of the output file, or nullptr.
+		* @param log Stream for progress messages.
+		* @param err Stream for error messages.
+		*/
+		void processPath(const std::filesystem::path& path, const std::string& outputDir, bool measureTime, std::ostream* out, std::ostream& log, std::ostream& err);
+		/**
+		* Processes one puzzle or, if many is set, all puzzles read from the text with nextPuzzle().
+		* @param name Name of the text used in messages.
+		*/
+		void processStream(TextReader& in, std::ostream& out, const std::string& name, bool many, bool measureTime, std::ostream& log, std::ostream& err);
+		/**
+		* Processes one puzzle, records its latency and frees its state.
+		* @param name Name of the puzzle used in error messages.
+		* @param many Whether the puzzle is one of many, in which case the failure reason is also written to out to keep the order of results.
+		* @return The outcome. If the puzzle could not be solved the reason is written to err.
+		*/
+		Outcome processPuzzle(std::string_view puzzle, std::ostream& out, const std::string& name, bool many, std::ostream& err);
+		/**
+		* Solves the files, or the standard input if stream is given, in a Pipeline with the given number of solver threads.
+		* Each task in progress has its own instance of the algorithm created with clone().
+		* @param out Stream for all results used instead of output files, or nullptr.
+		*/
+		void processPipeline(const std::vector<std::filesystem::path>& files, TextReader* stream, const std::string& outputDir, int workers,
+			bool measureTime, std::ostream* out, std::ostream& log, std::ostream& err);
+		/**
+		* Prints the counters of the algorithm instance that processed the puzzle, adds them to the totals and resets them.
+		*/
+		void reportCounters(PuzzleAlgorithm& algorithm, const std::string& name, std::ostream& log);
+		/**
+		* Writes the reason of a failed puzzle to err and, if many is set, to out.
+		* @return The outcome matching the error.
+		*/
+		static Outcome reportFailure(std::exception_ptr error, std::ostream& out, const std::string& name, bool many, std::ostream& err);
+	};
+
+	class Neighbours;
+
+	/**
+	* A fixed group of worker threads executing submitted tasks.
+	*/
+	class ThreadPool {
+	private:
+		std::vector<std::thread> workers;
+		std::queue<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable taskAvailable;
+		std::condition_variable tasksDone;
+		int activeTasks;
+		bool stopping;
+		std::exception_ptr error;
+
+		void workerLoop();
+	public:
+		/**
+		* @param threads Number of worker threads. 0 means the number of hardware threads.
+		*/
+		ThreadPool(int threads = 0);
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		inline int size() const { return (int)workers.size(); }
+
+		/**
+		* Queues the task for execution on one of the worker threads.
+		*/
+		void submit(std::function<void()> task);
+		/**
+		* Blocks until all tasks submitted to the pool, by any caller, are finished.
+		* If any task threw an exception, the first one is rethrown here. Use a TaskGroup to wait only for your own tasks.
+		*/
+		void wait();
+
+		/**
+		* Returns the pool shared by the whole program, created on first use with one thread per hardware thread.
+		*/
+		static ThreadPool& shared();
+	};
+
+	/**
+	* Tasks executed by a ThreadPool and waited for together. The group tracks only its own tasks and errors,
+	* so many groups can share one pool without waiting for each other's work.
+	*/
+	class TaskGroup {
+	private:
+		ThreadPool& pool;
+		int pending;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable tasksDone;
+	public:
+		TaskGroup(ThreadPool& pool);
+		/**
+		* Waits for the tasks still running, without rethrowing their errors.
+		*/
+		~TaskGroup();
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		/**
+		* Queues the task for execution on one of the threads of the pool.
+		*/
+		void submit(std::function<void()> task);
+		/**
+		* Blocks until all tasks of the group are finished.
+		* If any of them threw an exception, the first one is rethrown here.
+		*/
+		void wait();
+	};
+
+	/**
+	* Daemon solving puzzles sent over a Unix domain socket, with warm instances of the algorithms.
+	*
+	* A request is a header line "<algorithm> <length>" followed by length bytes of the puzzle text.
+	* The response is a header line "<outcome> <length>" followed by length bytes of the result, where outcome is
+	* one of the names from RunSummary::nameOf or "unknown_algorithm". In case of failure the result is the reason, as in batch mode.
+	* A client may send many requests without waiting, responses come in the order of the requests.
+	* At most a few dozen requests of a connection wait for their responses, further ones are not read until the client reads the responses.
+	*/
+	class SolverServer {
+	private:
+		struct Connection;
+
+		std::vector<std::shared_ptr<PuzzleAlgorithm>> algorithms;
+		// Instances of each algorithm not solving anything now, one per worker thread
+		std::vector<std::vector<std::shared_ptr<PuzzleAlgorithm>>> idle;
+		std::mutex idleMutex;
+		ThreadPool pool;
+
+		// Set and closed by run(), shut down by stop(). Changed only with connectionsMutex locked
+		int listenSocket;
+		std::atomic<bool> stopping;
+		// Sockets of open connections, shut down by stop()
+		std::vector<int> connections;
+		std::mutex connectionsMutex;
+		std::condition_variable connectionsClosed;
+
+		std::shared_ptr<PuzzleAlgorithm> acquire(int algorithm);
+		void release(int algorithm, std::shared_ptr<PuzzleAlgorithm> instance);
+		/**
+		* Reads requests from the client until it closes the connection. Responses are written by a second thread.
+		*/
+		void serveConnection(int socket);
+		void writeResponses(std::shared_ptr<Connection> connection);
+	public:
+		/**
+		* @param algorithms Algorithms served, selected by getName(). Each worker thread gets its own instance of every algorithm.
+		* @param workers Number of worker threads. 0 means the number of hardware threads.
+		* @param timeout Time limit of a single puzzle, zero means no limit.
+		*/
+		SolverServer(const std::vector<std::shared_ptr<PuzzleAlgorithm>>& algorithms, int workers = 0,
+			std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+		~SolverServer();
+		SolverServer(const SolverServer&) = delete;
+		SolverServer& operator=(const SolverServer&) = delete;
+
+		/**
+		* Listens on the socket path, replacing an existing socket file, and serves clients until stop() is called.
+		* @throws std::runtime_error When the socket cannot be created.
+		*/
+		void run(const std::string& socketPath);
+		/**
+		* Same as run(), but SIGINT and SIGTERM stop the server, which then removes the socket file and returns.
+		* The previous handlers of the signals are restored on return. Only one server in the process may run this way at a time.
+		*/
+		void runUntilSignal(const std::string& socketPath);
+		/**
+		* Stops accepting clients and closes the open connections. Responses not sent yet are dropped. Can be called from another thread.
+		*/
+		void stop();
+	};
+
+	/**
+	* Represents the x and y coordinates in a two-dimensional array
+	*/
+	class Index {
+	public:
+		int x;
+		int y;
+		constexpr Index() : x(0), y(0) { }
+		constexpr Index(const Index& other) : x(other.x), y(other.y) { }
+		constexpr Index(int x, int y) : x(x), y(y) { }
+		constexpr Index& operator=(const Index& other) = default;
+		/**
+		* Returns the coordinates of the neighboring indices
+		* @param sides Whether to return neighbors located on the sides (top, bottom, left, right).
+		* @param corners Whether to return neighbors located on the corners.
+		* @return A fixed-capacity range of neighboring coordinates. It does not allocate memory.
+		*/
+		constexpr Neighbours neighbours(bool sides = true, bool corners = true) const;
+		inline Index copy() { return Index(x, y); }
+
+		constexpr Index operator+(const Index& o) const { return Index(x + o.x, y + o.y); }
+		constexpr Index operator-(const Index& o) const { return Index(x - o.x, y - o.y); }
+		constexpr bool operator==(const Index& o) const { return x == o.x && y == o.y; }
+		constexpr bool operator!=(const Index& o) const { return x != o.x || y != o.y; }
+		constexpr bool operator<(const Index& o) const { return y < o.y || (y == o.y && x < o.x); }
+
+		friend std::ostream& operator<<(std::ostream&, const Index&);
+	};
+
+	std::ostream& operator<<(std::ostream&, const Index&);
+
+	/**
+	* Fixed-capacity list of up to 8 neighbouring indices stored inline. Can be used in range-for loops.
+	* It also serves as a short list of indices passed around without allocating memory.
+	*/
+	class Neighbours {
+	private:
+		Index items[8];
+		int count;
+	public:
+		constexpr Neighbours() : count(0) { }
+		constexpr Neighbours(std::initializer_list<Index> list) : count(0)
+		{
+			for (const Index& idx : list) push_back(idx);
+		}
+
+		constexpr void push_back(const Index& idx) { items[count++] = idx; }
+		constexpr int size() const { return count; }
+		constexpr bool empty() const { return count == 0; }
+
+		constexpr const Index* begin() const { return items; }
+		constexpr const Index* end() const { return items + count; }
+		constexpr const Index& operator [](int i) const { return items[i]; }
+	};
+
+	/**
+	* Offsets of the neighbours in the order returned by Index::neighbours. The first 4 are sides, the last 4 are corners.
+	*/
+	constexpr Index neighbourOffsets[8] = {
+		Index(0, 1), Index(1, 0), Index(0, -1), Index(-1, 0),
+		Index(1, 1), Index(1, -1), Index(-1, 1), Index(-1, -1)
+	};
+
+	constexpr Neighbours Index::neighbours(bool sides, bool corners) const
+	{
+		Neighbours result;
+		int first = sides ? 0 : 4;
+		int last = corners ? 8 : 4;
+		for (int i = first; i < last; i++) {
+			result.push_back(*this + neighbourOffsets[i]);
+		}
+		return result;
+	}
+
+	/**
+	* Value of the Board dimension template parameters meaning that the dimensions are given at runtime.
+	*/
+	constexpr int dynamicSize = 0;
+
+	/**
+	* Represents a board of dimensions W x H known at compile time. Elements are stored inside the object,
+	* so the board does not allocate and all index arithmetic is done on constants.
+	* @tparam T The type of elements stored on the board.
+	* @tparam W The width of the board.
+	* @tparam H The height of the board.
+	*/
+	template <typename T, int W = dynamicSize, int H = dynamicSize>
+	class Board {
+		static_assert(W > 0 && H > 0, "Board dimensions must be positive");
+	protected:
+		T tab[W * H];
+	public:
+		static constexpr int width = W;
+		static constexpr int height = H;
+		static constexpr int size = W * H;
+
+		static constexpr int getWidth() { return W; }
+		static constexpr int getHeight() { return H; }
+		static constexpr int getMargin() { return 0; }
+		static constexpr int getStride() { return W; }
+
+		/**
+		* Processes each element of the board by calling the given function on its coordinates and value.
+		* The loop is unrolled at compile time, the fields are visited row by row.
+		* @param func Callable invoked for each element of the board. Arguments are the coordinates and value of the element.
+		*/
+		template <typename F>
+		void forEach(F&& func) const
+		{
+			forEachUnrolled(func, std::make_integer_sequence<int, W * H>());
+		}
+		/**
+		* Same as forEach, but the function receives a reference through which the element can be modified.
+		*/
+		template <typename F>
+		void forEachMutable(F&& func)
+		{
+			forEachMutableUnrolled(func, std::make_integer_sequence<int, W * H>());
+		}
+		/**
+		* Sets every field of the board to the given value.
 		*/
-		void setInput(std::string value);
+		void fill(const T& value)
+		{
+			std::fill(tab, tab + W * H, value);
+		}
 		/**
-		* Sets the path to the output directory.
-		* The substring "<alg_name>" will be replaced in the runAlgorithm() method by the algorithm name
+		* Checks if the given index is within the board's scope.
 		*/
-		void setOutput(std::string value);
+		static constexpr bool inRange(const Index& index) { return index.x >= 0 && index.x < W && index.y >= 0 && index.y < H; }
+		static constexpr bool inMargin(const Index& index) { return inRange(index); }
 
 		/**
-		* Run the algorithm for each file in the input folder
+		* Returns the position of the field in the buffer.
 		*/
-		void runAlgorithm(bool measureTime);
+		static constexpr int offset(int x, int y) { return y * W + x; }
+		static constexpr int offset(const Index& idx) { return offset(idx.x, idx.y); }
 
-		virtual std::string getName();
 		/**
-		* Prints the format for the user that the input file should have to be handled by the algorithm
+		* Indexing operator (element access) for the board.
+		* @throws std::out_of_range When the index is outside the board's range.
 		*/
-		virtual void printFormat(std::ostream& o);
-	protected:
+		T& operator [](const Index& idx)
+		{
+			if (inRange(idx)) {
+				return tab[offset(idx)];
+			}
+			throw std::out_of_range("Index out of range");
+		}
 		/**
-		* The concrete method reads the problem from a file. It processes it, then writes the result to the file. The body of the function should be overridden
-		* 
-		* @param inFile
-		*	stream to input file with problem to read
-		* @param outFile
-		*	stream to file for saving results
-		* @param fileName
-		*	name of current process file
+		* Indexing operator (element access) for the board.
+		* @throws std::out_of_range When the index is outside the board's range.
 		*/
-		virtual void processFile(std::ifstream& inFile, std::ofstream& outFile) = 0;
+		const T& operator [](const Index& idx) const
+		{
+			if (inRange(idx)) {
+				return tab[offset(idx)];
+			}
+			throw std::out_of_range("Index out of range");
+		}
+
 		/**
-		* The function is always called after processFile.
-		* It should be used to free variables before running the algorithm for the next file.
+		* Element access without range checking.
 		*/
-		virtual void cleanUp() = 0;
-	};
+		inline T& at(int x, int y) { return tab[offset(x, y)]; }
+		inline const T& at(int x, int y) const { return tab[offset(x, y)]; }
 
-	/**
-	* Represents the x and y coordinates in a two-dimensional array
-	*/
-	class Index {
-	public:
-		int x;
-		int y;
-		Index();
-		Index(const Index& other);
-		Index(int x, int y);
 		/**
-		* Returns the coordinates of the neighboring indices
-		* @param sides Whether to return neighbors located on the sides (top, bottom, left, right).
-		* @param corners Whether to return neighbors located on the corners.
-		* @return A vector of neighboring coordinates.
+		* Returns a pointer to the first field of the row.
 		*/
-		std::vector<Index> neighbours(bool sides, bool corners) const;
-		inline Index copy() { return Index(x, y); }
-
-		inline Index operator+(const Index& o) const { return Index(x + o.x, y + o.y); }
-		inline Index operator-(const Index& o) const { return Index(x - o.x, y - o.y); }
-		inline bool operator==(const Index& o) const { return x == o.x && y == o.y; }
-		inline bool operator!=(const Index& o) const { return x != o.x || y != o.y; }
-		inline bool operator<(const Index& o) const { return y < o.y || (y == o.y && x < o.x); }
+		inline T* row(int y) { return tab + offset(0, y); }
+		inline const T* row(int y) const { return tab + offset(0, y); }
 
-		friend std::ostream& operator<<(std::ostream&, const Index&);
+	private:
+		template <typename F, int... I>
+		void forEachUnrolled(F& func, std::integer_sequence<int, I...>) const
+		{
+			(func(Index(I % W, I / W), tab[I]), ...);
+		}
+		template <typename F, int... I>
+		void forEachMutableUnrolled(F& func, std::integer_sequence<int, I...>)
+		{
+			(func(Index(I % W, I / W), tab[I]), ...);
+		}
 	};
 
-	std::ostream& operator<<(std::ostream&, const Index&);
-
 	/**
 	* Represents a board of dimensions width x height that can hold elements of type T.
+	* Elements are kept in one contiguous row-major buffer. The board can be surrounded by a margin ring
+	* of the given thickness, so reads of neighbours just outside the board return the margin value without a range check.
 	* @tparam T The type of elements stored on the board.
 	*/
 	template <typename T>
-	class Board {
+	class Board<T, dynamicSize, dynamicSize> {
 	private:
 		int width;
 		int height;
+		int margin;
+		int stride;
+		bool ownsBuffer;
+
+		inline int bufferSize() const { return stride * (height + 2 * margin); }
 	protected:
-		T** tab;
+		T* tab;
 	public:
-		Board(int width, int height) : width(width), height(height)
+		/**
+		* @param width The width of the board.
+		* @param height The height of the board.
+		* @param margin Thickness of the ring of additional fields around the board.
+		* @param marginValue The value the margin fields are filled with.
+		* @param arena Optional arena the buffer is taken from. The buffer is then released by Arena::reset, not by the board.
+		*/
+		Board(int width, int height, int margin = 0, const T& marginValue = T(), Arena* arena = nullptr)
+			: width(width), height(height), margin(margin), stride(width + 2 * margin), ownsBuffer(arena == nullptr)
+		{
+			tab = arena ? arena->createArray<T>(bufferSize()) : new T[bufferSize()];
+			std::fill(tab, tab + bufferSize(), marginValue);
+		}
+		Board(const Board& other) : width(other.width), height(other.height), margin(other.margin), stride(other.stride), ownsBuffer(true)
+		{
+			tab = new T[bufferSize()];
+			std::copy(other.tab, other.tab + bufferSize(), tab);
+		}
+		Board& operator=(const Board& other)
 		{
-			tab = new T*[width];
-			for (int x = 0; x < width; x++) {
-				tab[x] = new T[height];
+			if (this == &other) return *this;
+			if (bufferSize() != other.bufferSize()) {
+				if (ownsBuffer) delete[] tab;
+				tab = new T[other.bufferSize()];
+				ownsBuffer = true;
 			}
+			width = other.width;
+			height = other.height;
+			margin = other.margin;
+			stride = other.stride;
+			std::copy(other.tab, other.tab + bufferSize(), tab);
+			return *this;
 		}
 		~Board()
 		{
-			for (int x = 0; x < width; x++) {
-				delete[] tab[x];
-			}
-			delete[] tab;
+			if (ownsBuffer) delete[] tab;
 		}
 		inline int getWidth() const { return width; }
 		inline int getHeight() const { return height; }
+		inline int getMargin() const { return margin; }
+		/**
+		* Returns the distance between two vertically adjacent fields in the buffer.
+		*/
+		inline int getStride() const { return stride; }
 		/**
 		* Processes each element of the board by calling the given function on its coordinates and value.
-		* @param func Function called for each element of the board. Arguments are the coordinates and value of the element.
+		* The fields are visited row by row.
+		* @param func Callable invoked for each element of the board. Arguments are the coordinates and value of the element.
+		*/
+		template <typename F>
+		void forEach(F&& func) const
+		{
+			for (int y = 0; y < height; y++) {
+				const T* r = row(y);
+				for (int x = 0; x < width; x++) {
+					func(Index(x, y), r[x]);
+				}
+			}
+		}
+		/**
+		* Same as forEach, but the function receives a reference through which the element can be modified.
 		*/
-		void forEach(std::function <void(Index, T)> func)
+		template <typename F>
+		void forEachMutable(F&& func)
 		{
-			for (int x = 0; x < width; x++) {
-				for (int y = 0; y < height; y++) {
-					func(Index(x, y), tab[x][y]);
+			for (int y = 0; y < height; y++) {
+				T* r = row(y);
+				for (int x = 0; x < width; x++) {
+					func(Index(x, y), r[x]);
 				}
 			}
 		}
 		/**
+		* Same as forEachMutable, but the board is split into bands of rows processed concurrently by the threads of the pool.
+		* The function must be safe to call from many threads at once. It must not be called from a task of the same pool.
+		* @param func Callable invoked for each element of the board. Arguments are the coordinates and a reference to the element.
+		* @param pool The thread pool that processes the bands.
+		*/
+		template <typename F>
+		void parallelForEach(F&& func, ThreadPool& pool = ThreadPool::shared())
+		{
+			int bands = std::min(pool.size(), height);
+			TaskGroup group(pool);
+			for (int band = 0; band < bands; band++) {
+				int first = height * band / bands;
+				int last = height * (band + 1) / bands;
+				group.submit([this, &func, first, last]() {
+					for (int y = first; y < last; y++) {
+						T* r = row(y);
+						for (int x = 0; x < width; x++) {
+							func(Index(x, y), r[x]);
+						}
+					}
+				});
+			}
+			group.wait();
+		}
+		/**
+		* Sets every field of the board (without the margin) to the given value.
+		*/
+		void fill(const T& value)
+		{
+			for (int y = 0; y < height; y++) {
+				std::fill(row(y), row(y) + width, value);
+			}
+		}
+		/**
 		* Checks if the given index is within the board's scope.
 		* @param index The index coordinates.
 		* @return true if the index is within the board's scope, false otherwise.
 		*/
 		inline bool inRange(const Index& index) const { return index.x >= 0 && index.x < width && index.y >= 0 && index.y < height; }
+		/**
+		* Checks if the given index is within the board or its margin.
+		*/
+		inline bool inMargin(const Index& index) const { return index.x >= -margin && index.x < width + margin && index.y >= -margin && index.y < height + margin; }
+
+		/**
+		* Returns the position of the field in the buffer. The field may lie in the margin.
+		*/
+		inline int offset(int x, int y) const { return (y + margin) * stride + x + margin; }
+		inline int offset(const Index& idx) const { return offset(idx.x, idx.y); }
 
 		/**
 		* Indexing operator (element access) for the board.
@@ -151,7 +1320,7 @@ namespace baselib{
 		T& operator [](const Index& idx)
 		{
 			if (inRange(idx)) {
-				return tab[idx.x][idx.y];
+				return tab[offset(idx)];
 			}
 			throw std::out_of_range("Index out of range");
 		}
@@ -164,47 +1333,385 @@ namespace baselib{
 		const T& operator [](const Index& idx) const
 		{
 			if (inRange(idx)) {
-				return tab[idx.x][idx.y];
+				return tab[offset(idx)];
 			}
 			throw std::out_of_range("Index out of range");
 		}
 
 		/**
-		* Indexing operator without using the Index object.
-		* The inline method does not check if the index is in the range of the array. For safety, use the [] operator with Index.
+		* Element access without using the Index object.
+		* The inline method does not check if the coordinates are in the range of the board or its margin. For safety, use the [] operator with Index.
 		* @param x The x coordinate.
-		* @return A pointer to a row in the table.
+		* @param y The y coordinate.
+		* @return The element at the given coordinates.
 		*/
-		inline T* operator [](const int& x)
+		inline T& at(int x, int y) { return tab[offset(x, y)]; }
+		inline const T& at(int x, int y) const { return tab[offset(x, y)]; }
+
+		/**
+		* Returns a pointer to the first field of the row. Fields of the row are stored one after another.
+		* The inline method does not check if the row is in the range of the board.
+		* @param y The y coordinate.
+		*/
+		inline T* row(int y) { return tab + offset(0, y); }
+		inline const T* row(int y) const { return tab + offset(0, y); }
+	};
+
+	template <typename T, int W, int H>
+	std::ostream& operator<<(std::ostream& os, const Board<T, W, H>& board)
+	{
+		for (int y = 0; y < board.getHeight(); y++) {
+			const T* r = board.row(y);
+			for (int x = 0; x < board.getWidth(); x++) {
+				os << r[x] << " ";
+			}
+			os << std::endl;
+		}
+		return os;
+	}
+
+	/**
+	* Incrementally maintained 64-bit Zobrist hash of a board state.
+	* Each (field, value) pair has a pseudo-random key derived by a splitmix64 mix of the pair instead of a stored table,
+	* so values of any range are supported. The value 0 has no key, so an all-zero board hashes to 0.
+	* Changing a field costs two key computations; the whole board never has to be rehashed.
+	*/
+	class ZobristHash {
+	private:
+		uint64_t hash;
+	public:
+		ZobristHash() : hash(0) { }
+
+		static inline uint64_t key(int field, int value)
 		{
-			return tab[x];
+			if (value == 0) return 0;
+			uint64_t z = ((uint64_t)(uint32_t)field << 32 | (uint32_t)value) + 0x9e3779b97f4a7c15ull;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
 		}
 		/**
-		* Indexing operator without using the Index object.
-		* The inline method does not check if the index is in the range of the array. For safety, use the [] operator with Index.
-		* @param x The x coordinate.
-		* @return A pointer to a row in the table.
+		* Computes the hash of the whole board from scratch. Fields are identified by their offsets in the board buffer.
 		*/
-		inline const T* operator [](const int& x) const
+		template <typename B>
+		static uint64_t ofBoard(const B& board)
 		{
-			return tab[x];
+			uint64_t result = 0;
+			board.forEach([&board, &result](Index idx, int value) { result ^= key(board.offset(idx), value); });
+			return result;
 		}
 
-		template <typename T2>
-		friend std::ostream& operator<<(std::ostream&, const Board<T2>&);
+		inline uint64_t get() const { return hash; }
+		inline void set(uint64_t value) { hash = value; }
+		/**
+		* Adds or removes the (field, value) pair from the hashed state.
+		*/
+		inline void toggle(int field, int value) { hash ^= key(field, value); }
+		/**
+		* Records the change of the field from the old value to the new one.
+		*/
+		inline void update(int field, int oldValue, int newValue) { hash ^= key(field, oldValue) ^ key(field, newValue); }
 	};
 
+	/**
+	* Journal of writes to memory holding values of type T (usually fields of a Board), allowing to restore earlier states.
+	* Each write through the trail stores the address and the previous value, so undoing costs O(number of changes).
+	* The recorded fields must not be moved or freed while the trail refers to them.
+	* @tparam T The type of the recorded values.
+	*/
 	template <typename T>
-	std::ostream& operator<<(std::ostream& os, const Board<T>& board)
-	{
-		for (int y = 0; y < board.height; y++) {
-			for (int x = 0; x < board.width; x++) {
-				os << board.tab[x][y] << " ";
+	class Trail {
+	private:
+		std::vector<std::pair<T*, T>> entries;
+	public:
+		using Mark = std::size_t;
+
+		/**
+		* Returns the current position in the journal. Pass it to undoTo to restore the state from this moment.
+		*/
+		inline Mark mark() const { return entries.size(); }
+		inline std::size_t size() const { return entries.size(); }
+
+		/**
+		* Remembers the current value of the field. Call it before modifying the field directly.
+		*/
+		inline void record(T& field) { entries.emplace_back(&field, field); }
+		/**
+		* Remembers the current value of the field and writes the new one. Nothing is recorded if the value does not change.
+		*/
+		inline void write(T& field, const T& value)
+		{
+			if (field == value) return;
+			entries.emplace_back(&field, field);
+			field = value;
+		}
+		/**
+		* Restores, in reverse order, all the values changed after the given mark was taken.
+		*/
+		void undoTo(Mark m)
+		{
+			while (entries.size() > m) {
+				auto& entry = entries.back();
+				*entry.first = entry.second;
+				entries.pop_back();
 			}
-			os << std::endl;
 		}
-		return os;
-	}
+		/**
+		* Forgets all recorded changes without restoring them.
+		*/
+		inline void clear() { entries.clear(); }
+	};
+
+	/**
+	* Exact cover solver: Knuth's Algorithm X on a dancing links matrix.
+	* The matrix is built once with addRow. Each search starts with selectRow for the rows known to be in the solution,
+	* then search finds the rest. reset restores the matrix for the next search without rebuilding it.
+	*/
+	class DancingLinks {
+	private:
+		// Nodes 0..columns are the root and the column headers, the rest are the nodes of rows
+		std::vector<int> left;
+		std::vector<int> right;
+		std::vector<int> up;
+		std::vector<int> down;
+		std::vector<int> columnOf;
+		std::vector<int> rowOf;
+		// First node of each row
+		std::vector<int> rowStart;
+		// Number of nodes in each column, indexed by the header node
+		std::vector<int> size;
+		std::vector<bool> covered;
+		// Rows chosen by selectRow, to be released by reset
+		std::vector<int> selected;
+		std::vector<int> solution;
+		Counter nodes;
+
+		void cover(int column);
+		void uncover(int column);
+		bool searchFrom(CancellationToken* cancellation);
+	public:
+		/**
+		* @param columns Number of columns, all of them have to be covered.
+		*/
+		DancingLinks(int columns);
+
+		/**
+		* Adds a row covering the given columns.
+		* @return Number of the row.
+		*/
+		int addRow(const int* columns, int count);
+		inline int addRow(const std::vector<int>& columns) { return addRow(columns.data(), (int)columns.size()); }
+
+		/**
+		* Puts the row in the solution before the search.
+		* @return false if one of its columns is already covered by a selected row, so there is no solution.
+		*/
+		bool selectRow(int row);
+		/**
+		* Finds the first solution, choosing the column with the fewest rows at each step.
+		* @param cancellation Checked at every node of the search, may be nullptr.
+		* @return false if there is no solution.
+		*/
+		bool search(CancellationToken* cancellation = nullptr);
+		/**
+		* Returns the rows of the solution found by the last search, including the selected ones.
+		*/
+		inline const std::vector<int>& getSolution() const { return solution; }
+		/**
+		* Releases the selected rows and clears the solution.
+		*/
+		void reset();
+		/**
+		* Counter of visited nodes of the search tree.
+		*/
+		inline Counter& getNodeCounter() { return nodes; }
+	};
+
+	/**
+	* Union-find of elements 0..size-1 where each pair of elements in one set is known to be either the same or opposite.
+	* Uses path compression and union by rank. Each set also keeps its smallest element, which can serve as its name.
+	* When recording is enabled every change is journaled, so the structure can be rolled back with undoTo.
+	*/
+	class ParityDSU {
+	private:
+		// Fields of one element in data
+		enum Field { PARENT, RANK, PARITY, SMALLEST, SMALLEST_PARITY, FIELDS };
+
+		// For each element: parent, rank, parity relative to the parent (0 - same, 1 - opposite),
+		// and for roots the smallest element of the set with its parity relative to the root
+		std::vector<int> data;
+		// Pairs (position in data, old value). Position -1 means that elements were added and the old value is the previous size
+		std::vector<std::pair<int, int>> journal;
+		bool recording;
+
+		inline int& field(int element, Field f) { return data[element * FIELDS + f]; }
+		inline void set(int element, Field f, int value)
+		{
+			if (recording) journal.emplace_back(element * FIELDS + f, field(element, f));
+			field(element, f) = value;
+		}
+	public:
+		using Mark = std::size_t;
+
+		ParityDSU(int size = 0);
+
+		inline int size() const { return (int)data.size() / FIELDS; }
+		/**
+		* Reserves memory for the given number of elements, so adding them does not allocate.
+		*/
+		inline void reserve(int elements) { data.reserve((std::size_t)elements * FIELDS); }
+		/**
+		* Adds a new element in a set of its own.
+		* @return The new element.
+		*/
+		int add();
+		/**
+		* Makes the structure contain the given number of separate elements. Clears the journal.
+		*/
+		void reset(int size);
+		/**
+		* Enables or disables journaling of changes. Disabling it clears the journal.
+		*/
+		void setRecording(bool value);
+
+		/**
+		* Returns the root of the set containing the element.
+		* @param parity Receives 1 if the element is opposite to the root, 0 otherwise.
+		*/
+		int find(int a, int& parity);
+		inline int find(int a) { int parity; return find(a, parity); }
+		/**
+		* Returns the smallest element of the set containing the element.
+		* @param parity Receives 1 if the element is opposite to the smallest one, 0 otherwise.
+		*/
+		int smallest(int a, int& parity);
+
+		/**
+		* Checks if the relation between the elements is known.
+		*/
+		inline bool sameSet(int a, int b) { return find(a) == find(b); }
+		/**
+		* Checks if the elements are known to be the same.
+		*/
+		bool same(int a, int b);
+		/**
+		* Checks if the elements are known to be opposite.
+		*/
+		bool opposite(int a, int b);
+		/**
+		* Joins the sets of both elements, so that the elements are the same or opposite.
+		* @return false if this contradicts the relation already known, the structure is then unchanged.
+		*/
+		bool unite(int a, int b, bool opposite);
+
+		inline Mark mark() const { return journal.size(); }
+		/**
+		* Reverts all changes made after the mark was taken. Works only for changes made while recording.
+		*/
+		void undoTo(Mark m);
+	};
+
+	/**
+	* Represents a board of boolean values packed into 64-bit words, one or more words per row.
+	* Whole-board operations (logical operators, shifts, counting) are performed on entire words.
+	* Bits beyond the width of the board are always kept at 0.
+	*/
+	class BitBoard {
+	private:
+		int width;
+		int height;
+		int wordsPerRow;
+		std::vector<uint64_t> words;
+
+		inline uint64_t lastWordMask() const { return width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1; }
+		void clearPadding();
+	public:
+		BitBoard(int width, int height);
+
+		/**
+		* Creates a bit board with bits set for the fields of the board that satisfy the predicate.
+		* @param board Any Board.
+		* @param pred Callable taking the value of the field and returning bool.
+		*/
+		template <typename B, typename P>
+		static BitBoard fromBoard(const B& board, P pred)
+		{
+			BitBoard result(board.getWidth(), board.getHeight());
+			for (int y = 0; y < result.height; y++) {
+				const auto* r = board.row(y);
+				for (int x = 0; x < result.width; x++) {
+					if (pred(r[x])) result.set(x, y);
+				}
+			}
+			return result;
+		}
+
+		inline int getWidth() const { return width; }
+		inline int getHeight() const { return height; }
+		inline bool inRange(const Index& index) const { return index.x >= 0 && index.x < width && index.y >= 0 && index.y < height; }
+
+		/**
+		* Reads the bit without range checking.
+		*/
+		inline bool get(int x, int y) const { return (words[y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1; }
+		inline bool get(const Index& idx) const { return get(idx.x, idx.y); }
+		/**
+		* Sets or clears the bit without range checking.
+		*/
+		inline void set(int x, int y, bool value = true)
+		{
+			uint64_t& word = words[y * wordsPerRow + (x >> 6)];
+			uint64_t bit = uint64_t(1) << (x & 63);
+			word = value ? word | bit : word & ~bit;
+		}
+		inline void set(const Index& idx, bool value = true) { set(idx.x, idx.y, value); }
+
+		/**
+		* Sets all bits of the board to the given value.
+		*/
+		void fill(bool value);
+		/**
+		* Returns the number of set bits.
+		*/
+		int count() const;
+		bool any() const;
+
+		/**
+		* Returns the board moved by one field in the given direction. Bits moved outside the board are lost.
+		* North decreases y, south increases y, east increases x, west decreases x.
+		*/
+		BitBoard north() const;
+		BitBoard south() const;
+		BitBoard east() const;
+		BitBoard west() const;
+		/**
+		* Returns the board with every set bit expanded to its side neighbours.
+		*/
+		BitBoard dilate() const;
+		/**
+		* Returns the set bits of the mask connected (by sides) with the set bits of this board.
+		* @param mask The fields through which the fill can spread.
+		*/
+		BitBoard floodFill(const BitBoard& mask) const;
+
+		BitBoard& operator&=(const BitBoard& o);
+		BitBoard& operator|=(const BitBoard& o);
+		BitBoard& operator^=(const BitBoard& o);
+		/**
+		* Clears the bits that are set in the other board.
+		*/
+		BitBoard& andNot(const BitBoard& o);
+		BitBoard operator~() const;
+		bool operator==(const BitBoard& o) const;
+
+		inline BitBoard operator&(const BitBoard& o) const { BitBoard r(*this); return r &= o; }
+		inline BitBoard operator|(const BitBoard& o) const { BitBoard r(*this); return r |= o; }
+		inline BitBoard operator^(const BitBoard& o) const { BitBoard r(*this); return r ^= o; }
+
+		friend std::ostream& operator<<(std::ostream&, const BitBoard&);
+	};
+
+	std::ostream& operator<<(std::ostream&, const BitBoard&);
 
 	/**
 	* Represents a coordinate transformation on the board with the possibility of rotation and mirroring.
@@ -227,6 +1734,15 @@ namespace baselib{
 		*/
 		Index transform(const Index& idx) const;
 
+		/**
+		* Applies the transformation to all given indexes.
+		* @param in The indexes to transform.
+		* @param out Array receiving the transformed indexes. Must hold count elements.
+		* @param count Number of indexes.
+		*/
+		void transform(const Index* in, Index* out, int count) const;
+		std::vector<Index> transform(const std::vector<Index>& indexes) const;
+
 		/**
 		* Calls transform method
 		*/
@@ -237,4 +1753,42 @@ namespace baselib{
 	* Calls IndexTransform transform method
 	*/
 	Index operator *(const Index& idx, const IndexTransform& transform);
+
+	/**
+	* Holds a pattern of indexes transformed by all 8 symmetries of the square (rotations and mirror images).
+	* The transformed indexes and their offsets in a board buffer of the given stride are computed once,
+	* so matching the pattern is reduced to table lookups.
+	* Symmetries 0-3 are the rotations by 0, 1, 2 and 3 right turns, 4-7 are the same rotations applied to the mirrored pattern.
+	*/
+	class SymmetryGroup {
+	private:
+		int patternSize;
+		int stride;
+		std::vector<IndexTransform> transforms;
+		std::vector<Index> indexes;
+		std::vector<int> offsets;
+	public:
+		static constexpr int count = 8;
+
+		/**
+		* @param width The width of the area the pattern is defined in.
+		* @param height The height of the area the pattern is defined in.
+		* @param pattern Indexes of the pattern, relative to the area.
+		* @param stride The distance between vertically adjacent fields in the buffer of the board the pattern is matched on.
+		*/
+		SymmetryGroup(int width, int height, const std::vector<Index>& pattern, int stride);
+
+		inline int size() const { return patternSize; }
+		inline int getStride() const { return stride; }
+		inline const IndexTransform& transform(int symmetry) const { return transforms[symmetry]; }
+		/**
+		* Returns the transformed pattern indexes for the given symmetry.
+		*/
+		inline const Index* indexesOf(int symmetry) const { return indexes.data() + symmetry * patternSize; }
+		/**
+		* Returns the buffer offsets of the transformed pattern indexes for the given symmetry.
+		* Add them to the buffer position of the field the pattern is anchored at.
+		*/
+		inline const int* offsetsOf(int symmetry) const { return offsets.data() + symmetry * patternSize; }
+	};
 }
\ No newline at end of file
@@ -34,14 +34,31 @@ namespace algorithms {
 			int height;
 			std::vector<Node> nodes;
 			std::vector<Range> ranges;
+			// Non-empty lines of the processed input, reused between files
+			std::vector<std::string_view> lines;
+			// Hash of the established links (nextNode of each node)
+			ZobristHash linkHash;
+			// Calls of searchPath, each visiting one node of the search tree
+			Counter searchNodes;
 		public:
 			Algorithm();
 			~Algorithm();
+			std::shared_ptr<PuzzleAlgorithm> clone() const override;
 			std::string getName() override;
 			void printFormat(std::ostream& o) override;
+			/**
+			* Returns the Zobrist hash of the links established so far
+			*/
+			inline uint64_t getHash() const { return linkHash.get(); }
 		protected:
-			void prepare(std::ifstream& in);
-			void processFile(std::ifstream& inFile, std::ofstream& outFile) override;
+			void prepare(std::string_view input);
+			void parse(std::string_view input) override;
+			void solve() override;
+			void format(std::ostream& outFile) override;
+			/**
+			* The puzzle is solved when every node has its order.
+			*/
+			bool isSolved() override;
 			void cleanUp() override;
 
 			void mainLoop();
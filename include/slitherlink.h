@@ -30,12 +30,76 @@ namespace algorithms {
 		*/
 		class ColorBoard : public Board<int> {
 		protected:
-			int colorMargin;
-			int nextColor;
+			// Fields hold color labels. Labels are elements of classes, which store which colors were merged into the same or the opposite one.
+			// The color of the field is the smallest label of the class, negated if the label is opposite to it or the field holds a negative label.
+			mutable ParityDSU classes;
+			Trail<int>* trail;
+			ZobristHash hash;
+			// Counter of mergeColors calls, may be nullptr
+			Counter* merges;
+
+			/**
+			* Writes the value to the field, recording the old one in the trail if it is attached and updating the hash.
+			*/
+			inline void write(int& field, int value)
+			{
+				hash.update((int)(&field - tab), field, value);
+				if (trail) trail->write(field, value);
+				else field = value;
+			}
 		public:
 			bool updateFlag;
+
+			/**
+			* State of the board to which it can be rolled back
+			*/
+			struct Mark {
+				Trail<int>::Mark fields;
+				ParityDSU::Mark classes;
+				uint64_t hash;
+			};
 		public:
-			ColorBoard(int width, int height);
+			ColorBoard(int width, int height, Arena* arena = nullptr);
+			/**
+			* Attaches a trail that records every change of the colors, so the board can be rolled back with mark and undoTo.
+			* Pass nullptr to stop recording.
+			*/
+			inline void setTrail(Trail<int>* value)
+			{
+				trail = value;
+				classes.setRecording(value != nullptr);
+			}
+			/**
+			* Sets the counter incremented by every mergeColors call. Pass nullptr to stop counting.
+			*/
+			inline void setMergeCounter(Counter* value) { merges = value; }
+			inline Mark mark() const { return Mark{ trail ? trail->mark() : 0, classes.mark(), hash.get() }; }
+			/**
+			* Restores the fields, the classes of the colors and the hash from the moment the mark was taken.
+			* Without a trail no changes were recorded, so the board is left as it is.
+			*/
+			inline void undoTo(const Mark& m)
+			{
+				if (!trail) return;
+				trail->undoTo(m.fields);
+				classes.undoTo(m.classes);
+				hash.set(m.hash);
+			}
+			/**
+			* Returns the Zobrist hash of the fields. Boards with equal colors have equal hashes after normalizeColors,
+			* which also makes the hash independent of the color numbers.
+			*/
+			inline uint64_t getHash() const { return hash.get(); }
+			/**
+			* Returns the color represented by the label.
+			*/
+			inline int colorOf(int label) const
+			{
+				if (label == 0) return 0;
+				int parity;
+				int color = classes.smallest(label < 0 ? -label : label, parity);
+				return (label < 0) != (parity != 0) ? -color : color;
+			}
 			/**
 			* Colors the fields with the given indexes the same color.
 			* If the fields do not contain colors (value 0) a new color will be assigned,
@@ -44,23 +108,28 @@ namespace algorithms {
 			* @param indexes - list of indexes of fields to paint.
 			* @param oposite - optional list of indexes of fields to paint in the opposite color.
 			*/
-			void colorSame(std::vector<Index> indexes, std::vector<Index> oposite);
+			void colorSame(const Neighbours& indexes, const Neighbours& oposite = Neighbours());
 
 			/**
-			* Unifies the given colors and their opposites into one lowest on the list.
+			* Unifies the given colors and their opposites into the one with the lowest absolute value.
 			* Example: If the numbers 1 and -2 are given, all -2 numbers will become 1 and all 2 numbers will become -1
+			* The fields are not rewritten, only the classes of the colors are joined.
+			* @param colors Distinct non-zero colors.
+			* @param count Number of the colors.
+			* @throws NoSolutionException When a color would have to become its own opposite.
 			*/
-			int mergeColors(const std::set<int>& colors);
+			int mergeColors(const int* colors, int count);
 			/**
-			* Reduces colors to the smallest possible values
+			* Reduces colors to the smallest possible values.
+			* Every field is rewritten to its color and the classes are cleared, so changes made before cannot be undone.
 			*/
 			void normalizeColors();
 
-			int& operator [](const Index& idx);
-			const int& operator [](const Index& idx) const;
-			
-			int* operator [](const int& x);
-			const int* operator [](const int& x) const;
+			/**
+			* Returns the color of the field. Fields outside the board belong to the margin ring and have color 1.
+			* The index must not lie further than one field from the board.
+			*/
+			inline int operator [](const Index& idx) const { return colorOf(tab[offset(idx)]); }
 
 			friend std::ostream& operator<<(std::ostream&, const ColorBoard&);
 		};
@@ -71,14 +140,34 @@ namespace algorithms {
 		protected:
 			ColorBoard* colorBoard;
 			Board<int>* numbers;
+			// 2x2 window (lt, lb, rt, rb) in all orientations, with offsets in the colorBoard buffer
+			SymmetryGroup* crosses;
+			// Two 3's touching by corners (diagonal) or by sides (row), followed by the fields colored around them,
+			// with offsets in the numbers buffer
+			SymmetryGroup* diagonalThrees;
+			SymmetryGroup* rowThrees;
 			std::vector<Index> updateNumbers;
+			// Iterations of the solving steps and merges of colors
+			Counter countNeighboursSteps;
+			Counter checkCrossesSteps;
+			Counter expandAreasSteps;
+			Counter mergeColorsCalls;
+			// Non-empty lines of the processed input, reused between files
+			std::vector<std::string_view> lines;
 		public:
 			Algorithm();
 			~Algorithm();
+			std::shared_ptr<PuzzleAlgorithm> clone() const override;
 			std::string getName() override;
 			void printFormat(std::ostream& o) override;
 		protected:
-			void processFile(std::ifstream& inFile, std::ofstream& outFile) override;
+			void parse(std::string_view input) override;
+			void solve() override;
+			void format(std::ostream& outFile) override;
+			/**
+			* The puzzle is solved when every field has the color of the surroundings or its opposite.
+			*/
+			bool isSolved() override;
 			void cleanUp() override;
 
 			/**
@@ -109,11 +198,15 @@ namespace algorithms {
 
 		class BFSAreaVerifier {
 		private:
-			Board<bool> visited;
+			BitBoard visited;
 			const ColorBoard& colors;
+			CancellationToken* cancellation;
 
 		public:
-			BFSAreaVerifier(const ColorBoard& colors);
+			/**
+			* @param cancellation Checked for every field of the board, can be null.
+			*/
+			BFSAreaVerifier(const ColorBoard& colors, CancellationToken* cancellation = nullptr);
 
 		private:
 			BFSAreaResult bfs(Index start);
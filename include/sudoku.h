@@ -1,5 +1,8 @@
 #pragma once
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
 
 #include "base-lib.h"
 
@@ -14,46 +17,219 @@ Smart backtracking algorithm
 namespace algorithms {
 	namespace sudoku {
 
+		/**
+		* Field filled in the search, with the digits still to try in it
+		*/
+		template <typename Mask>
 		struct Memory {
-			int row;
-			int col;
-			int area;
-			int mask;
+			int field;
+			Mask mask;
 		};
 
-		class Algorithm : public PuzzleAlgorithm {
+		/**
+		* Method of solving the puzzle
+		*/
+		enum class Engine {
+			// Bitmask backtracking in mainLoop
+			BACKTRACKING,
+			// Exact cover with dancing links
+			DLX,
+			// Candidate bitboards of BandSolver, only for 9x9
+			BITBOARD
+		};
+
+		/**
+		* Bit-parallel 9x9 solver. The possible fields of each digit are an 81-bit set split into three bands of 27 bits,
+		* which are processed at once in the lanes of a 128-bit vector (SSE2, with SSE4.1 when available, or plain integers).
+		* Propagation applies naked and hidden singles and box-line reductions with whole-set operations.
+		* The search copies the state before each guess, so nothing has to be undone.
+		*/
+		class BandSolver {
+		private:
+			struct State;
+			Counter guesses;
+
+			bool search(State& state, int* cells, CancellationToken* cancellation);
+			/**
+			* @return false if the state has no solution.
+			*/
+			bool propagate(State& state);
+		public:
+			/**
+			* Solves the puzzle.
+			* @param cells 81 fields in row-major order with digits from 0 to 8, -1 if empty. Receives the solution.
+			* @param cancellation Checked at every node of the search, can be null.
+			* @return false if the puzzle has no solution.
+			*/
+			bool solve(int* cells, CancellationToken* cancellation);
+			/**
+			* Counter of guessed digits.
+			*/
+			inline Counter& getGuessCounter() { return guesses; }
+		};
+
+		template <int N>
+		class BasicAlgorithm;
+
+		template <int N>
+		std::ostream& operator<<(std::ostream&, const BasicAlgorithm<N>&);
+
+		/**
+		* Sudoku of N*N x N*N fields divided into N x N areas, with digits from 1 to N*N.
+		* Instantiated for N from 2 to 5 (4x4 up to 25x25) in algorithm.cpp.
+		* @tparam N The order of the sudoku: the size of an area.
+		*/
+		template <int N>
+		class BasicAlgorithm : public PuzzleAlgorithm {
+			static_assert(N >= 2 && N <= 5, "Sudoku order must be from 2 to 5");
+		public:
+			// Number of digits, the width and height of the table
+			static constexpr int size = N * N;
+			static constexpr int fieldCount = size * size;
+			static constexpr int unitCount = 3 * size;
+			// Set of digits, bit l is digit l. Sudoku up to 16x16 fits in 16 bits
+			using Mask = std::conditional_t<(size <= 16), std::uint16_t, std::uint32_t>;
+			static constexpr Mask fullMask = (Mask)((1u << size) - 1);
 		protected:
-			// Numbers in table from 0 to 8. -1 if empty
-			int tab[9][9];
+			// Numbers in table from 0 to size - 1. -1 if empty
+			Board<int, size, size> tab;
 			// Are values in original state
-			bool taken[9][9];
+			Board<bool, size, size> taken;
 
 			// Masks that says which numbers are allow to enter in specific area
-			// Number l is allowed to place if 1 << l is 1. Therefor numbers are from 0 to 8 not from 1 to 9. Full mask is 0x1ff
+			// Number l is allowed to place if 1 << l is 1. Therefor numbers are from 0 to size - 1 not from 1 to size
 			// Mask in field is row & col & area
-			int rows[9];
-			int cols[9];
-			int area[3][3];
+			Mask rows[size];
+			Mask cols[size];
+			Board<Mask, N, N> area;
+
+			// Fields filled by the search in order, reused between files.
+			// Digits entered by propagation are kept with an empty mask, so backtracking removes them like exhausted branches
+			std::vector<Memory<Mask>> memory;
+			// Empty fields of the puzzle. The first memory.size() of them are filled, in the order of the memory
+			int fields[fieldCount];
+			// Position of each field in fields
+			int fieldPosition[fieldCount];
+			int emptyCount;
+			// Fields of the units: rows, columns and areas
+			int units[unitCount][size];
+
+			// Hash of tab, updated with every change of the table
+			ZobristHash hash;
+			// Whether mainLoop found a solution for the current puzzle
+			bool solved;
+			// Set when a clue repeats a digit of its row, column or area, so no engine is run
+			bool conflict;
+
+			// Digits entered and returns to the previous field in mainLoop
+			Counter placements;
+			Counter backtracks;
+			// Branches with more than one digit to try, and digits entered by propagation
+			Counter guesses;
+			Counter propagated;
+			// Nodes visited by the exact cover searches
+			Counter dlxNodes;
+
+			Engine engine;
+			// Exact cover matrix of the empty board: size^3 rows (cell, digit) covering 4 * size^2 columns
+			// (cell filled, digit in row, digit in column, digit in area). Built when the dlx engine is first used
+			std::unique_ptr<DancingLinks> dlx;
+			BandSolver bands;
 		public:
-			Algorithm();
-			~Algorithm();
+			BasicAlgorithm();
+			~BasicAlgorithm();
+			std::shared_ptr<PuzzleAlgorithm> clone() const override;
 			std::string getName() override;
+			int getVersion() override;
+			bool setEngine(const std::string& name) override;
 			void printFormat(std::ostream& o) override;
+			bool nextPuzzle(TextReader& in, std::string_view& puzzle) override;
+			/**
+			* Returns the Zobrist hash of the current table
+			*/
+			inline uint64_t getHash() const { return hash.get(); }
 		protected:
-			void processFile(std::ifstream& inFile, std::ofstream& outFile) override;
+			void parse(std::string_view input) override;
+			void solve() override;
+			void format(std::ostream& outFile) override;
+			bool isSolved() override;
 			void cleanUp() override;
-			void prepare(std::ifstream& inFile);
+			void prepare(std::string_view input);
+			/**
+			* Reads size characters of the row y into the table and masks. A clue whose digit is already in its row,
+			* column or area sets conflict.
+			*/
+			void parseRow(const char* row, int y);
+			inline void setField(int x, int y, int value)
+			{
+				hash.update(tab.offset(x, y), tab.at(x, y) + 1, value + 1);
+				tab.at(x, y) = value;
+			}
 
-			inline void nextFreeField(int& i) const;
-			inline void backToPreviousField(int& i) const;
+			/**
+			* Returns the mask of digits that can be entered in the empty field
+			*/
+			inline Mask candidates(int i) const
+			{
+				return rows[i / size] & cols[i % size] & area.at(i % size / N, i / (size * N));
+			}
+			/**
+			* Enters the lowest digit of the mask to the field and removes it from the mask
+			*/
+			inline void enterNext(Memory<Mask>& m);
+			/**
+			* Clears the field, giving its digit back to the masks
+			*/
+			inline void clearField(int i);
+			/**
+			* Moves the empty field at position j of fields to the end of the filled ones and adds it to the memory with the mask
+			*/
+			inline Memory<Mask>& pushField(int j, Mask mask);
+			/**
+			* Lists the empty fields of the parsed puzzle in fields and clears the memory, before propagate and the search
+			*/
+			void collectEmptyFields();
+			/**
+			* Enters naked singles (fields with one possible digit) and hidden singles (digits with one possible field in a unit)
+			* until none is left. Entered digits are added to the memory.
+			* @return false if some field has no possible digit or some digit has no possible field in a unit.
+			*/
+			bool propagate();
 
 			bool mainLoop();
+			/**
+			* Builds the exact cover matrix, unless it is built already.
+			*/
+			void buildExactCover();
+			/**
+			* Solves the puzzle as an exact cover problem and fills the table with the solution.
+			*/
+			bool solveExactCover();
+			/**
+			* Solves the puzzle with BandSolver and fills the table with the solution. Only used for 9x9.
+			*/
+			bool solveBands();
 
 		public:
-			friend std::ostream& operator<<(std::ostream&, const Algorithm&);
+			friend std::ostream& operator<< <>(std::ostream&, const BasicAlgorithm&);
 		};
 
-		std::ostream& operator<<(std::ostream&, const Algorithm&);
+		/**
+		* Returns the digit written as the character: 1-9, then letters from A (case insensitive). -1 if it is not a digit of the sudoku.
+		*/
+		int parseDigit(char c, int size);
+		/**
+		* Returns the character of the digit from 0 to size - 1, the inverse of parseDigit.
+		*/
+		char digitChar(int value);
+
+		// The classic 9x9 sudoku
+		using Algorithm = BasicAlgorithm<3>;
+
+		extern template class BasicAlgorithm<2>;
+		extern template class BasicAlgorithm<3>;
+		extern template class BasicAlgorithm<4>;
+		extern template class BasicAlgorithm<5>;
 
 	};
 }
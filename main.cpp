@@ -17,16 +17,27 @@ int main(int argc, char* argv[]) {
 	vector<shared_ptr<baselib::PuzzleAlgorithm>> all_algorithms;
 	all_algorithms.push_back(make_shared<algorithms::slitherlink::Algorithm>());
 	all_algorithms.push_back(make_shared<algorithms::sudoku::Algorithm>());
+	all_algorithms.push_back(make_shared<algorithms::sudoku::BasicAlgorithm<2>>());
+	all_algorithms.push_back(make_shared<algorithms::sudoku::BasicAlgorithm<4>>());
+	all_algorithms.push_back(make_shared<algorithms::sudoku::BasicAlgorithm<5>>());
 	all_algorithms.push_back(make_shared<algorithms::signpost::Algorithm>());
 
 	Options options("PuzzleAlgorithm", "Algorithms and generators for popular puzzles");
 	options.add_options()
 		("a,algorithm", "Select puzzle algorithm", value<string>())
 		("l,list", "List possible puzzle algorithms")
-		("i,input", "Input directory - default = ./samples/<alg_name>/in/", value<string>())
-		("o,output", "Output directory - default = ./samples/<alg_name>/out/", value<string>())
+		("i,input", "Input directory, - for standard input - default = ./samples/<alg_name>/in/", value<string>())
+		("o,output", "Output directory, - for standard output - default = ./samples/<alg_name>/out/", value<string>())
 		("f,format", "Print selected algorithm file format")
-		("t,time", "Measure time for each file")
+		("t,time", "Measure time for each file and print a summary of puzzle latencies")
+		("s,summary", "Write the summary of the run as JSON to the file", value<string>())
+		("stats", "Print solver counters for each puzzle and their totals")
+		("serve", "Serve requests of all algorithms on the Unix domain socket, with --jobs worker threads (default = one per hardware thread)", value<string>())
+		("cache", "File with cached results of solved puzzles, created if it does not exist", value<string>())
+		("timeout", "Time limit for solving a single puzzle in milliseconds, 0 = no limit - default = 0", value<int>())
+		("e,engine", "Solving engine of the selected algorithm, listed with --format", value<string>())
+		("b,batch", "Each input file contains many puzzles, results are written to one output file in the same order")
+		("j,jobs", "Number of solver threads, 0 = one per hardware thread - default = 1", value<int>())
 		("h,help", "Print help");
 	ParseResult result;
 	try {
@@ -47,6 +58,34 @@ int main(int argc, char* argv[]) {
 		cout << options.help();
 		return 0;
 	}
+	if (result.count("cache") == 1) {
+		try {
+			auto cache = make_shared<baselib::SolutionCache>(result["cache"].as<string>());
+			for (auto& alg : all_algorithms) alg->setCache(cache);
+		}
+		catch (exception& e) {
+			cerr << e.what() << endl;
+			return 1;
+		}
+	}
+	if (result.count("serve") == 1) {
+		int jobs = result.count("j") == 1 ? result["j"].as<int>() : 0;
+		chrono::milliseconds timeout(result.count("timeout") == 1 ? result["timeout"].as<int>() : 0);
+		// The engine applies to the algorithms which have it
+		if (result.count("e") == 1) {
+			for (auto& alg : all_algorithms) alg->setEngine(result["e"].as<string>());
+		}
+		try {
+			baselib::SolverServer server(all_algorithms, jobs, timeout);
+			// Ctrl+C or kill stops the server and removes the socket file
+			server.runUntilSignal(result["serve"].as<string>());
+		}
+		catch (exception& e) {
+			cerr << e.what() << endl;
+			return 1;
+		}
+		return 0;
+	}
 	if (result.count("a") == 1) {
 		string value = result["a"].as<string>();
 		for (auto& alg : all_algorithms) {
@@ -63,6 +102,24 @@ int main(int argc, char* argv[]) {
 	if (result.count("o") == 1) {
 		if (algorithm) algorithm->setOutput(result["o"].as<string>());
 	}
+	if (result.count("b") > 0) {
+		if (algorithm) algorithm->setBatch(true);
+	}
+	if (result.count("e") == 1) {
+		if (algorithm && !algorithm->setEngine(result["e"].as<string>())) {
+			cout << "Unknown engine, use --format to show the engines of the algorithm" << endl;
+			return 0;
+		}
+	}
+	if (result.count("s") == 1) {
+		if (algorithm) algorithm->setSummaryPath(result["s"].as<string>());
+	}
+	if (result.count("stats") > 0) {
+		if (algorithm) algorithm->setStats(true);
+	}
+	if (result.count("timeout") == 1) {
+		if (algorithm) algorithm->setTimeout(chrono::milliseconds(result["timeout"].as<int>()));
+	}
 	if (result.count("f") > 0) {
 		if (algorithm) {
 			algorithm->printFormat(cout);
@@ -72,7 +129,8 @@ int main(int argc, char* argv[]) {
 
 	try {
 		if (algorithm) {
-			algorithm->runAlgorithm(result.count("t") > 0);
+			int jobs = result.count("j") == 1 ? result["j"].as<int>() : 1;
+			algorithm->runAlgorithm(result.count("t") > 0, jobs);
 		}
 		else {
 			cout << options.help();
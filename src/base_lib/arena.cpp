@@ -0,0 +1,57 @@
+#include <base-lib.h>
+
+#include <cstdint>
+
+using namespace baselib;
+
+Arena::Arena(std::size_t blockSize) : blockSize(blockSize), currentBlock(0), used(0) { }
+
+Arena::~Arena()
+{
+	reset();
+	for (Block& block : blocks) {
+		::operator delete(block.data);
+	}
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+	while (currentBlock < blocks.size()) {
+		Block& block = blocks[currentBlock];
+		std::uintptr_t start = reinterpret_cast<std::uintptr_t>(block.data) + used;
+		std::uintptr_t aligned = (start + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+		std::size_t end = aligned - reinterpret_cast<std::uintptr_t>(block.data) + size;
+		if (end <= block.size) {
+			used = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+		currentBlock++;
+		used = 0;
+	}
+
+	// No block with enough free space - add a new one at the end
+	Block block;
+	block.size = std::max(blockSize, size + alignment);
+	block.data = static_cast<char*>(::operator new(block.size));
+	blocks.push_back(block);
+	currentBlock = blocks.size() - 1;
+	used = 0;
+	return allocate(size, alignment);
+}
+
+void Arena::reset()
+{
+	for (auto it = destructors.rbegin(); it != destructors.rend(); it++) {
+		it->second(it->first);
+	}
+	destructors.clear();
+	currentBlock = 0;
+	used = 0;
+}
+
+std::size_t Arena::capacity() const
+{
+	std::size_t result = 0;
+	for (const Block& block : blocks) result += block.size;
+	return result;
+}
@@ -0,0 +1,151 @@
+#include <base-lib.h>
+
+#include <bit>
+
+using namespace baselib;
+
+BitBoard::BitBoard(int width, int height)
+	: width(width), height(height), wordsPerRow((width + 63) / 64), words(wordsPerRow * height, 0) { }
+
+void BitBoard::clearPadding()
+{
+	if (wordsPerRow == 0) return;
+	uint64_t mask = lastWordMask();
+	for (int y = 0; y < height; y++) {
+		words[y * wordsPerRow + wordsPerRow - 1] &= mask;
+	}
+}
+
+void BitBoard::fill(bool value)
+{
+	std::fill(words.begin(), words.end(), value ? ~uint64_t(0) : 0);
+	if (value) clearPadding();
+}
+
+int BitBoard::count() const
+{
+	int result = 0;
+	for (uint64_t word : words) result += std::popcount(word);
+	return result;
+}
+
+bool BitBoard::any() const
+{
+	for (uint64_t word : words) {
+		if (word) return true;
+	}
+	return false;
+}
+
+BitBoard BitBoard::north() const
+{
+	BitBoard result(width, height);
+	if (height > 1) std::copy(words.begin() + wordsPerRow, words.end(), result.words.begin());
+	return result;
+}
+
+BitBoard BitBoard::south() const
+{
+	BitBoard result(width, height);
+	if (height > 1) std::copy(words.begin(), words.end() - wordsPerRow, result.words.begin() + wordsPerRow);
+	return result;
+}
+
+BitBoard BitBoard::east() const
+{
+	BitBoard result(width, height);
+	for (int y = 0; y < height; y++) {
+		const uint64_t* src = &words[y * wordsPerRow];
+		uint64_t* dst = &result.words[y * wordsPerRow];
+		uint64_t carry = 0;
+		for (int i = 0; i < wordsPerRow; i++) {
+			dst[i] = (src[i] << 1) | carry;
+			carry = src[i] >> 63;
+		}
+	}
+	result.clearPadding();
+	return result;
+}
+
+BitBoard BitBoard::west() const
+{
+	BitBoard result(width, height);
+	for (int y = 0; y < height; y++) {
+		const uint64_t* src = &words[y * wordsPerRow];
+		uint64_t* dst = &result.words[y * wordsPerRow];
+		uint64_t carry = 0;
+		for (int i = wordsPerRow - 1; i >= 0; i--) {
+			dst[i] = (src[i] >> 1) | carry;
+			carry = src[i] << 63;
+		}
+	}
+	return result;
+}
+
+BitBoard BitBoard::dilate() const
+{
+	BitBoard result(*this);
+	result |= north();
+	result |= south();
+	result |= east();
+	result |= west();
+	return result;
+}
+
+BitBoard BitBoard::floodFill(const BitBoard& mask) const
+{
+	BitBoard result = *this & mask;
+	while (true) {
+		BitBoard next = result.dilate() & mask;
+		if (next == result) return result;
+		result = next;
+	}
+}
+
+BitBoard& BitBoard::operator&=(const BitBoard& o)
+{
+	for (size_t i = 0; i < words.size(); i++) words[i] &= o.words[i];
+	return *this;
+}
+
+BitBoard& BitBoard::operator|=(const BitBoard& o)
+{
+	for (size_t i = 0; i < words.size(); i++) words[i] |= o.words[i];
+	return *this;
+}
+
+BitBoard& BitBoard::operator^=(const BitBoard& o)
+{
+	for (size_t i = 0; i < words.size(); i++) words[i] ^= o.words[i];
+	return *this;
+}
+
+BitBoard& BitBoard::andNot(const BitBoard& o)
+{
+	for (size_t i = 0; i < words.size(); i++) words[i] &= ~o.words[i];
+	return *this;
+}
+
+BitBoard BitBoard::operator~() const
+{
+	BitBoard result(width, height);
+	for (size_t i = 0; i < words.size(); i++) result.words[i] = ~words[i];
+	result.clearPadding();
+	return result;
+}
+
+bool BitBoard::operator==(const BitBoard& o) const
+{
+	return width == o.width && height == o.height && words == o.words;
+}
+
+std::ostream& baselib::operator<<(std::ostream& os, const BitBoard& board)
+{
+	for (int y = 0; y < board.height; y++) {
+		for (int x = 0; x < board.width; x++) {
+			os << (board.get(x, y) ? '#' : '.');
+		}
+		os << std::endl;
+	}
+	return os;
+}
@@ -0,0 +1,20 @@
+#include <base-lib.h>
+
+using namespace baselib;
+
+CancellationToken::CancellationToken() : deadline(std::chrono::steady_clock::time_point::max()), cancelled(false), countdown(checkInterval) { }
+
+void CancellationToken::start(std::chrono::nanoseconds timeout)
+{
+	deadline = timeout.count() > 0 ? std::chrono::steady_clock::now() + timeout : std::chrono::steady_clock::time_point::max();
+	cancelled.store(false, std::memory_order_relaxed);
+	countdown = checkInterval;
+}
+
+void CancellationToken::poll()
+{
+	countdown = checkInterval;
+	if (cancelled.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() > deadline) {
+		throw TimeoutException();
+	}
+}
@@ -0,0 +1,28 @@
+#include <base-lib.h>
+
+using namespace baselib;
+
+void CounterRegistry::add(const char* name, Counter& counter)
+{
+	names.push_back(name);
+	counters.push_back(&counter);
+}
+
+void CounterRegistry::reset()
+{
+	for (Counter* counter : counters) counter->reset();
+}
+
+void CounterRegistry::addTo(std::vector<std::uint64_t>& totals) const
+{
+	if (totals.size() < counters.size()) totals.resize(counters.size(), 0);
+	for (std::size_t i = 0; i < counters.size(); i++) totals[i] += counters[i]->get();
+}
+
+void CounterRegistry::print(std::ostream& o, const std::vector<std::uint64_t>* values) const
+{
+	for (std::size_t i = 0; i < counters.size(); i++) {
+		if (i > 0) o << ", ";
+		o << names[i] << "=" << (values != nullptr && i < values->size() ? (*values)[i] : counters[i]->get());
+	}
+}
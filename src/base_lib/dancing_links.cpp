@@ -0,0 +1,139 @@
+#include <base-lib.h>
+
+using namespace baselib;
+
+DancingLinks::DancingLinks(int columns) : left(columns + 1), right(columns + 1), up(columns + 1), down(columns + 1),
+	columnOf(columns + 1), rowOf(columns + 1, -1), size(columns + 1, 0), covered(columns + 1, false)
+{
+	// Node 0 is the root, the headers of the columns follow it in a circular list
+	for (int i = 0; i <= columns; i++) {
+		left[i] = i == 0 ? columns : i - 1;
+		right[i] = i == columns ? 0 : i + 1;
+		up[i] = i;
+		down[i] = i;
+		columnOf[i] = i;
+	}
+}
+
+int DancingLinks::addRow(const int* columns, int count)
+{
+	int row = (int)rowStart.size();
+	int first = (int)left.size();
+	rowStart.push_back(first);
+	for (int i = 0; i < count; i++) {
+		int column = columns[i] + 1;
+		int node = first + i;
+		left.push_back(i == 0 ? first + count - 1 : node - 1);
+		right.push_back(i == count - 1 ? first : node + 1);
+		up.push_back(up[column]);
+		down.push_back(column);
+		columnOf.push_back(column);
+		rowOf.push_back(row);
+		down[up[column]] = node;
+		up[column] = node;
+		size[column]++;
+	}
+	return row;
+}
+
+void DancingLinks::cover(int column)
+{
+	covered[column] = true;
+	right[left[column]] = right[column];
+	left[right[column]] = left[column];
+	for (int i = down[column]; i != column; i = down[i]) {
+		for (int j = right[i]; j != i; j = right[j]) {
+			down[up[j]] = down[j];
+			up[down[j]] = up[j];
+			size[columnOf[j]]--;
+		}
+	}
+}
+
+void DancingLinks::uncover(int column)
+{
+	for (int i = up[column]; i != column; i = up[i]) {
+		for (int j = left[i]; j != i; j = left[j]) {
+			size[columnOf[j]]++;
+			down[up[j]] = j;
+			up[down[j]] = j;
+		}
+	}
+	right[left[column]] = column;
+	left[right[column]] = column;
+	covered[column] = false;
+}
+
+bool DancingLinks::selectRow(int row)
+{
+	int first = rowStart[row];
+	int node = first;
+	do {
+		if (covered[columnOf[node]]) return false;
+		node = right[node];
+	} while (node != first);
+
+	do {
+		cover(columnOf[node]);
+		node = right[node];
+	} while (node != first);
+	selected.push_back(row);
+	return true;
+}
+
+bool DancingLinks::search(CancellationToken* cancellation)
+{
+	solution = selected;
+	return searchFrom(cancellation);
+}
+
+bool DancingLinks::searchFrom(CancellationToken* cancellation)
+{
+	++nodes;
+	if (cancellation) cancellation->check();
+	if (right[0] == 0) return true;
+
+	// The column with the fewest rows gives the smallest branching
+	int column = right[0];
+	for (int c = right[column]; c != 0; c = right[c]) {
+		if (size[c] < size[column]) column = c;
+	}
+	if (size[column] == 0) return false;
+
+	cover(column);
+	bool found = false;
+	for (int i = down[column]; i != column && !found; i = down[i]) {
+		solution.push_back(rowOf[i]);
+		for (int j = right[i]; j != i; j = right[j]) cover(columnOf[j]);
+		try {
+			found = searchFrom(cancellation);
+		}
+		catch (...) {
+			// Restore the matrix when the search is cancelled
+			for (int j = left[i]; j != i; j = left[j]) uncover(columnOf[j]);
+			uncover(column);
+			solution.pop_back();
+			throw;
+		}
+		for (int j = left[i]; j != i; j = left[j]) uncover(columnOf[j]);
+		if (!found) solution.pop_back();
+	}
+	uncover(column);
+	return found;
+}
+
+void DancingLinks::reset()
+{
+	// Rows are released in the reverse order of selection, which restores the links exactly
+	while (!selected.empty()) {
+		int first = rowStart[selected.back()];
+		selected.pop_back();
+		int node = left[first];
+		while (true) {
+			uncover(columnOf[node]);
+			if (node == first) break;
+			node = left[node];
+		}
+	}
+	solution.clear();
+}
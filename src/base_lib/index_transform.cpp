@@ -32,6 +32,20 @@ Index baselib::IndexTransform::transform(const Index& idx) const
     return Index(x, y);
 }
 
+void baselib::IndexTransform::transform(const Index* in, Index* out, int count) const
+{
+    for (int i = 0; i < count; i++) {
+        out[i] = transform(in[i]);
+    }
+}
+
+std::vector<Index> baselib::IndexTransform::transform(const std::vector<Index>& indexes) const
+{
+    std::vector<Index> result(indexes.size());
+    transform(indexes.data(), result.data(), (int)indexes.size());
+    return result;
+}
+
 Index baselib::IndexTransform::operator*(const Index& idx)
 {
     return transform(idx);
@@ -0,0 +1,65 @@
+#include <base-lib.h>
+
+#include <bit>
+#include <cmath>
+
+using namespace baselib;
+
+LatencyHistogram::LatencyHistogram() : counts(bucketCount, 0), total(0), minimum(UINT64_MAX), maximum(0), sum(0) { }
+
+int LatencyHistogram::bucketOf(std::uint64_t value)
+{
+	if (value < (std::uint64_t)linearBuckets) return (int)value;
+	// The highest precisionBits bits of the value select the bucket within its power of two
+	int shift = (63 - std::countl_zero(value)) - (precisionBits - 1);
+	int top = (int)(value >> shift);
+	return linearBuckets + (shift - 1) * halfBuckets + (top - halfBuckets);
+}
+
+std::uint64_t LatencyHistogram::upperBound(int bucket)
+{
+	if (bucket < linearBuckets) return bucket;
+	int shift = (bucket - linearBuckets) / halfBuckets + 1;
+	std::uint64_t top = (bucket - linearBuckets) % halfBuckets + halfBuckets;
+	return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value)
+{
+	counts[bucketOf(value)]++;
+	total++;
+	minimum = std::min(minimum, value);
+	maximum = std::max(maximum, value);
+	sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	for (int i = 0; i < bucketCount; i++) counts[i] += other.counts[i];
+	total += other.total;
+	minimum = std::min(minimum, other.minimum);
+	maximum = std::max(maximum, other.maximum);
+	sum += other.sum;
+}
+
+void LatencyHistogram::clear()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	total = 0;
+	minimum = UINT64_MAX;
+	maximum = 0;
+	sum = 0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double percent) const
+{
+	if (total == 0) return 0;
+	std::uint64_t rank = (std::uint64_t)std::ceil(percent / 100.0 * total);
+	rank = std::clamp<std::uint64_t>(rank, 1, total);
+	std::uint64_t seen = 0;
+	for (int i = 0; i < bucketCount; i++) {
+		seen += counts[i];
+		if (seen >= rank) return std::min(upperBound(i), maximum);
+	}
+	return maximum;
+}
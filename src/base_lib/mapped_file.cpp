@@ -0,0 +1,55 @@
+#include <base-lib.h>
+
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BASELIB_MMAP
+#endif
+
+using namespace baselib;
+
+MappedFile::MappedFile(const std::string& path) : data(nullptr), size(0), mapping(nullptr)
+{
+#ifdef BASELIB_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+		size = info.st_size;
+		if (size == 0) {
+			data = "";
+		}
+		else {
+			void* result = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (result != MAP_FAILED) {
+				mapping = result;
+				data = static_cast<const char*>(result);
+				madvise(result, size, MADV_SEQUENTIAL);
+			}
+		}
+	}
+	close(fd);
+	if (data != nullptr) return;
+	size = 0;
+#endif
+	// Fallback - read the whole file into the buffer
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return;
+	std::ostringstream content;
+	content << file.rdbuf();
+	buffer = content.str();
+	data = buffer.data();
+	size = buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef BASELIB_MMAP
+	if (mapping != nullptr) munmap(mapping, size);
+#endif
+}
@@ -0,0 +1,108 @@
+#include <base-lib.h>
+
+#include <utility>
+
+using namespace baselib;
+
+ParityDSU::ParityDSU(int size) : recording(false)
+{
+	reset(size);
+}
+
+int ParityDSU::add()
+{
+	int element = size();
+	if (recording) journal.emplace_back(-1, element);
+	data.insert(data.end(), { element, 0, 0, element, 0 });
+	return element;
+}
+
+void ParityDSU::reset(int size)
+{
+	data.clear();
+	journal.clear();
+	bool wasRecording = recording;
+	recording = false;
+	for (int i = 0; i < size; i++) add();
+	recording = wasRecording;
+}
+
+void ParityDSU::setRecording(bool value)
+{
+	recording = value;
+	if (!recording) journal.clear();
+}
+
+int ParityDSU::find(int a, int& parity)
+{
+	int root = a;
+	parity = 0;
+	while (field(root, PARENT) != root) {
+		parity ^= field(root, PARITY);
+		root = field(root, PARENT);
+	}
+
+	// Path compression - attach every element on the path directly to the root
+	int current = a;
+	int currentParity = parity;
+	while (field(current, PARENT) != root && current != root) {
+		int next = field(current, PARENT);
+		int nextParity = currentParity ^ field(current, PARITY);
+		set(current, PARENT, root);
+		set(current, PARITY, currentParity);
+		current = next;
+		currentParity = nextParity;
+	}
+
+	return root;
+}
+
+int ParityDSU::smallest(int a, int& parity)
+{
+	int root = find(a, parity);
+	parity ^= field(root, SMALLEST_PARITY);
+	return field(root, SMALLEST);
+}
+
+bool ParityDSU::same(int a, int b)
+{
+	int pa, pb;
+	return find(a, pa) == find(b, pb) && pa == pb;
+}
+
+bool ParityDSU::opposite(int a, int b)
+{
+	int pa, pb;
+	return find(a, pa) == find(b, pb) && pa != pb;
+}
+
+bool ParityDSU::unite(int a, int b, bool opposite)
+{
+	int pa, pb;
+	int ra = find(a, pa);
+	int rb = find(b, pb);
+	if (ra == rb) return (pa ^ pb) == (int)opposite;
+
+	// Parity between the roots
+	int relation = pa ^ pb ^ (int)opposite;
+	if (field(ra, RANK) < field(rb, RANK)) std::swap(ra, rb);
+
+	set(rb, PARENT, ra);
+	set(rb, PARITY, relation);
+	if (field(ra, RANK) == field(rb, RANK)) set(ra, RANK, field(ra, RANK) + 1);
+	if (field(rb, SMALLEST) < field(ra, SMALLEST)) {
+		set(ra, SMALLEST, field(rb, SMALLEST));
+		set(ra, SMALLEST_PARITY, field(rb, SMALLEST_PARITY) ^ relation);
+	}
+	return true;
+}
+
+void ParityDSU::undoTo(Mark m)
+{
+	while (journal.size() > m) {
+		auto& entry = journal.back();
+		if (entry.first == -1) data.resize(entry.second * FIELDS);
+		else data[entry.first] = entry.second;
+		journal.pop_back();
+	}
+}
@@ -4,11 +4,18 @@
 #include <fstream>
 #include <filesystem>
 #include <chrono>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <memory>
 
 using namespace baselib;
 namespace fs = std::filesystem;
 
-PuzzleAlgorithm::PuzzleAlgorithm() : input("./samples/<alg_name>/in"), output("./samples/<alg_name>/out") { }
+// Input or output path meaning the standard input or output
+static const std::string standardStream = "-";
+
+PuzzleAlgorithm::PuzzleAlgorithm() : input("./samples/<alg_name>/in"), output("./samples/<alg_name>/out"), batch(false), stats(false), timeout(0) { }
 PuzzleAlgorithm::~PuzzleAlgorithm() { }
 void PuzzleAlgorithm::setInput(std::string value)
 {
@@ -20,14 +27,78 @@ void PuzzleAlgorithm::setOutput(std::string value)
 	output = value;
 }
 
+void PuzzleAlgorithm::setBatch(bool value)
+{
+	batch = value;
+}
+
+void PuzzleAlgorithm::setSummaryPath(std::string value)
+{
+	summaryPath = value;
+}
+
+void PuzzleAlgorithm::setStats(bool value)
+{
+	stats = value;
+}
+
+void PuzzleAlgorithm::setTimeout(std::chrono::nanoseconds value)
+{
+	timeout = value;
+}
+
+void PuzzleAlgorithm::setCache(std::shared_ptr<SolutionCache> value)
+{
+	cache = value;
+}
+
+std::shared_ptr<SolutionCache> PuzzleAlgorithm::getCache() const
+{
+	return cache;
+}
+
 std::string PuzzleAlgorithm::getName()
 {
 	return std::string();
 }
 
+int PuzzleAlgorithm::getVersion()
+{
+	return 1;
+}
+
+bool PuzzleAlgorithm::setEngine(const std::string& name)
+{
+	return false;
+}
+
 void PuzzleAlgorithm::printFormat(std::ostream& o) { }
 
-void PuzzleAlgorithm::runAlgorithm(bool measureTime)
+bool PuzzleAlgorithm::nextPuzzle(TextReader& in, std::string_view& puzzle)
+{
+	std::string_view line;
+	bool any = false;
+	in.startGroup();
+	while (in.readLine(line)) {
+		if (line.empty()) {
+			if (any) break;
+			continue;
+		}
+		in.addToGroup(line);
+		any = true;
+	}
+	puzzle = in.getGroup();
+	return any;
+}
+
+Outcome PuzzleAlgorithm::solvePuzzle(std::string_view puzzle, std::ostream& out)
+{
+    // Messages for the error output are not needed, the reason is written to out
+    std::ostream discard(nullptr);
+    return processPuzzle(puzzle, out, getName(), true, discard);
+}
+
+void PuzzleAlgorithm::runAlgorithm(bool measureTime, int jobs)
 {
     std::string toReplace = "<alg_name>";
     std::string inputDir = input;
@@ -37,64 +108,445 @@ void PuzzleAlgorithm::runAlgorithm(bool measureTime)
     pos = outputDir.find(toReplace);
     if (pos != std::string::npos) outputDir.replace(pos, toReplace.length(), getName());
 
+    // With results on the standard output, progress messages go to the error output
+    bool toStdout = outputDir == standardStream;
+    std::ostream& log = toStdout ? std::cerr : std::cout;
+
+    if (!toStdout && !fs::exists(outputDir)) {
+        fs::create_directories(outputDir);
+    }
+
+    summary.start();
+    counterTotals.clear();
+    if (inputDir == standardStream) processInput(measureTime, jobs, outputDir, log);
+    else processDirectory(inputDir, measureTime, jobs, outputDir, log);
+    summary.stop();
+
+    if (measureTime) summary.print(log);
+    if (cache) {
+        log << "Cache: hits " << cache->getHits() << ", misses " << cache->getMisses() << std::endl;
+    }
+    if (stats) {
+        if (Counter::enabled) {
+            log << "Stats total: ";
+            counters.print(log, &counterTotals);
+            log << std::endl;
+        }
+        else log << "Stats are not available, the program was compiled without BASELIB_STATS" << std::endl;
+    }
+    if (!summaryPath.empty()) {
+        std::ofstream summaryFile(summaryPath);
+        if (summaryFile) summary.printJson(summaryFile);
+        else std::cerr << "Failed to open summary file: " << summaryPath << std::endl;
+    }
+}
+
+const RunSummary& PuzzleAlgorithm::getSummary() const
+{
+    return summary;
+}
+
+void PuzzleAlgorithm::processInput(bool measureTime, int jobs, const std::string& outputDir, std::ostream& log)
+{
+    // The standard input is a stream of puzzles, each result is written as soon as the puzzle is solved
+    bool toStdout = outputDir == standardStream;
+    std::ofstream outFile;
+    if (!toStdout) {
+        outFile.open(outputDir + "/stdin");
+        if (!outFile) {
+            std::cerr << "Failed to open output file: " << outputDir << "/stdin" << std::endl;
+            return;
+        }
+    }
+    TextReader reader(std::cin);
+    if (jobs == 1) processStream(reader, toStdout ? std::cout : outFile, "stdin", true, measureTime, log, std::cerr);
+    else processPipeline({}, &reader, outputDir, jobs, measureTime, toStdout ? &std::cout : &outFile, log, std::cerr);
+}
+
+void PuzzleAlgorithm::processDirectory(const std::string& inputDir, bool measureTime, int jobs, const std::string& outputDir, std::ostream& log)
+{
+    bool toStdout = outputDir == standardStream;
     if (!fs::exists(inputDir)) {
         fs::create_directories(inputDir);
     }
-    if (!fs::exists(outputDir)) {
-        fs::create_directories(outputDir);
+
+    if (jobs == 1) {
+        for (const auto& entry : fs::directory_iterator(inputDir)) {
+            if (entry.is_regular_file()) {
+                processPath(entry.path(), outputDir, measureTime, toStdout ? &std::cout : nullptr, log, std::cerr);
+            }
+        }
+        return;
     }
 
+    std::vector<fs::path> files;
     for (const auto& entry : fs::directory_iterator(inputDir)) {
-        if (entry.is_regular_file()) {
-            std::string inputFilePath = entry.path().string();
-            std::string fileName = entry.path().filename().string();
-            std::string outputFilePath = outputDir + "/" + fileName;
-
-            std::ifstream inFile(inputFilePath);
-            if (!inFile) {
-                std::cerr << "Failed to open input file: " << inputFilePath << std::endl;
-                continue;
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    processPipeline(files, nullptr, outputDir, jobs, measureTime, toStdout ? &std::cout : nullptr, log, std::cerr);
+}
+
+namespace {
+    // One puzzle passing through the pipeline, together with the instance of the algorithm holding its state
+    struct PuzzleTask {
+        std::shared_ptr<PuzzleAlgorithm> algorithm;
+        // Keeps the text of puzzles read from a file mapped until they are written
+        std::shared_ptr<MappedFile> file;
+        // Copy of a puzzle read from a stream
+        std::string text;
+        std::string fileName;
+        // Number of the puzzle in the file starting from 1, 0 for a file without puzzles
+        int number;
+        bool many;
+        // Message for a file that could not be opened
+        std::string openError;
+        std::exception_ptr error;
+        // Time spent in the phases of the puzzle
+        std::uint64_t nanoseconds;
+        // Key in the SolutionCache and the result found there
+        SolutionCache::Key key;
+        bool cached;
+        std::string_view cachedResult;
+    };
+
+    // Returns nanoseconds elapsed since the given time
+    std::uint64_t elapsedSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void PuzzleAlgorithm::processPipeline(const std::vector<fs::path>& files, TextReader* stream, const std::string& outputDir, int workers,
+    bool measureTime, std::ostream* out, std::ostream& log, std::ostream& err)
+{
+    if (workers <= 0) workers = std::max(1, (int)std::thread::hardware_concurrency());
+
+    // Reader state: the current file and the reader of its text
+    std::size_t nextFile = 0;
+    std::shared_ptr<MappedFile> file;
+    std::unique_ptr<TextReader> fileReader;
+    TextReader* reader = stream;
+    std::string fileName = stream != nullptr ? "stdin" : "";
+    bool many = stream != nullptr || batch;
+    int number = 0;
+
+    auto read = [&](PuzzleTask& task) -> bool {
+        task.file = nullptr;
+        task.openError.clear();
+        task.error = nullptr;
+        task.cached = false;
+        std::string_view puzzle;
+        while (true) {
+            if (reader == nullptr) {
+                if (nextFile >= files.size()) return false;
+                std::string path = files[nextFile++].string();
+                fileName = files[nextFile - 1].filename().string();
+                file = std::make_shared<MappedFile>(path);
+                number = 0;
+                if (!file->isOpen()) {
+                    task.openError = "Failed to open input file: " + path;
+                    task.fileName = fileName;
+                    // The slot may hold a puzzle already written, whose number must not reach the solvers
+                    task.number = 0;
+                    file = nullptr;
+                    return true;
+                }
+                fileReader = std::make_unique<TextReader>(file->view());
+                reader = fileReader.get();
             }
 
-            std::ofstream outFile(outputFilePath);
-            if (!outFile) {
-                std::cerr << "Failed to open output file: " << outputFilePath << std::endl;
-                if (inFile.is_open()) inFile.close();
+            bool found;
+            if (many) found = nextPuzzle(*reader, puzzle);
+            else {
+                puzzle = reader->readAll();
+                found = number == 0;
+            }
+            if (!found) {
+                // The end of a file, which still needs a task if it has no puzzles
+                bool empty = number == 0;
+                if (reader == stream) return false;
+                reader = nullptr;
+                if (empty) {
+                    task.fileName = fileName;
+                    task.number = 0;
+                    return true;
+                }
                 continue;
             }
 
+            if (reader->isStream()) {
+                task.text.assign(puzzle);
+                puzzle = task.text;
+            }
+            task.file = file;
+            task.fileName = fileName;
+            task.number = ++number;
+            task.many = many;
+            if (!task.algorithm) task.algorithm = clone();
+            auto start = std::chrono::steady_clock::now();
+            if (cache) {
+                task.key = SolutionCache::keyOf(getName(), getVersion(), puzzle);
+                task.cached = cache->find(task.key, task.cachedResult);
+            }
             try {
-                std::cout << "File: " << fileName << std::endl;
+                if (!task.cached) task.algorithm->parse(puzzle);
+            }
+            catch (...) {
+                task.error = std::current_exception();
+            }
+            task.nanoseconds = elapsedSince(start);
+            return true;
+        }
+    };
 
-                auto start_time = std::chrono::high_resolution_clock::now();
-                processFile(inFile, outFile);
-                auto end_time = std::chrono::high_resolution_clock::now();
+    auto solve = [this](int worker, PuzzleTask& task) {
+        if (task.number == 0 || !task.openError.empty() || task.error || task.cached) return;
+        auto start = std::chrono::steady_clock::now();
+        task.algorithm->cancellation.start(timeout);
+        try {
+            task.algorithm->solve();
+        }
+        catch (...) {
+            task.error = std::current_exception();
+        }
+        task.nanoseconds += elapsedSince(start);
+    };
 
-                if (measureTime) {
-                    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                    auto milliseconds = duration.count();
+    // Writer state: the output of the current file
+    std::ofstream outFile;
+    std::ostream* current = nullptr;
+    bool started = false;
+    bool currentMany = false;
+    int count = 0;
+    int failed = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-                    auto seconds = milliseconds / 1000;
-                    milliseconds %= 1000;
+    auto finishFile = [&]() {
+        if (!started) return;
+        started = false;
+        if (currentMany) log << "Puzzles: " << count << ", failed: " << failed << std::endl;
+        if (measureTime) {
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime);
+            auto milliseconds = duration.count();
+            log << "Duration: " << milliseconds / 1000 << ":" << milliseconds % 1000 << std::endl;
+        }
+        if (outFile.is_open()) outFile.close();
+    };
 
-                    std::cout << "Duration: " << seconds << ":" << milliseconds << std::endl;
-                }
-            }
-            catch (const WrongFileFormatException& e) {
-                std::cerr << "Wrong file format: " << fileName << std::endl;
+    auto write = [&](PuzzleTask& task) {
+        if (!task.openError.empty()) {
+            finishFile();
+            err << task.openError << std::endl;
+            return;
+        }
+        if (task.number <= 1) {
+            finishFile();
+            started = true;
+            currentMany = many;
+            count = 0;
+            failed = 0;
+            startTime = std::chrono::high_resolution_clock::now();
+            log << "File: " << task.fileName << std::endl;
+            current = out;
+            if (current == nullptr) {
+                std::string outputFilePath = outputDir + "/" + task.fileName;
+                outFile.open(outputFilePath);
+                if (outFile) current = &outFile;
+                else err << "Failed to open output file: " << outputFilePath << std::endl;
             }
-            catch (const NoSolutionException& e) {
-                std::cerr << "No solution: " << fileName << std::endl;
+        }
+        if (task.number == 0) return;
+
+        std::string name = task.many ? task.fileName + " #" + std::to_string(task.number) : task.fileName;
+        if (current != nullptr) {
+            if (count > 0) *current << "\n";
+            Outcome outcome = Outcome::SOLVED;
+            if (task.cached) *current << task.cachedResult;
+            else if (!task.error) {
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    if (cache) {
+                        std::ostringstream result;
+                        task.algorithm->format(result);
+                        if (task.algorithm->isSolved()) cache->store(task.key, result.str());
+                        *current << result.str();
+                    }
+                    else task.algorithm->format(*current);
+                }
+                catch (...) {
+                    task.error = std::current_exception();
+                }
+                task.nanoseconds += elapsedSince(start);
             }
-            catch (const std::exception & e) {
-                std::cerr << "Failed process file: " << fileName << std::endl;
-                std::cerr << e.what() << std::endl;
+            if (task.error) {
+                outcome = reportFailure(task.error, *current, name, task.many, err);
+                failed++;
             }
-            cleanUp();
+            summary.record(outcome, task.nanoseconds);
+            count++;
+            if (current == &std::cout) current->flush();
+        }
+        task.algorithm->cleanUp();
+        task.algorithm->arena.reset();
+        if (stats) reportCounters(*task.algorithm, name, log);
+        task.file = nullptr;
+    };
+
+    Pipeline<PuzzleTask> pipeline(workers, 4 * workers);
+    pipeline.run(read, solve, write);
+    finishFile();
+}
+
+void PuzzleAlgorithm::processPath(const fs::path& path, const std::string& outputDir, bool measureTime, std::ostream* out, std::ostream& log, std::ostream& err)
+{
+    std::string inputFilePath = path.string();
+    std::string fileName = path.filename().string();
+    std::string outputFilePath = outputDir + "/" + fileName;
+
+    MappedFile inFile(inputFilePath);
+    if (!inFile.isOpen()) {
+        err << "Failed to open input file: " << inputFilePath << std::endl;
+        return;
+    }
 
-            inFile.close();
-            outFile.close();
+    std::ofstream outFile;
+    if (out == nullptr) {
+        outFile.open(outputFilePath);
+        if (!outFile) {
+            err << "Failed to open output file: " << outputFilePath << std::endl;
+            return;
         }
+        out = &outFile;
     }
 
+    TextReader reader(inFile.view());
+    processStream(reader, *out, fileName, batch, measureTime, log, err);
+
+    if (outFile.is_open()) outFile.close();
+}
+
+void PuzzleAlgorithm::processStream(TextReader& in, std::ostream& out, const std::string& name, bool many, bool measureTime, std::ostream& log, std::ostream& err)
+{
+    log << "File: " << name << std::endl;
+
+    // Results written to the standard output are flushed after each puzzle, so they can be consumed before the input ends
+    bool flush = &out == &std::cout;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (many) {
+        // Puzzles are solved one by one as they are read, the results keep the order of the input
+        std::string_view puzzle;
+        int count = 0;
+        int failed = 0;
+        while (nextPuzzle(in, puzzle)) {
+            if (count > 0) out << "\n";
+            std::string puzzleName = name + " #" + std::to_string(count + 1);
+            if (processPuzzle(puzzle, out, puzzleName, true, err) != Outcome::SOLVED) failed++;
+            if (stats) reportCounters(*this, puzzleName, log);
+            if (flush) out.flush();
+            count++;
+        }
+        log << "Puzzles: " << count << ", failed: " << failed << std::endl;
+    }
+    else {
+        processPuzzle(in.readAll(), out, name, false, err);
+        if (stats) reportCounters(*this, name, log);
+        if (flush) out.flush();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    if (measureTime) {
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        auto milliseconds = duration.count();
+
+        auto seconds = milliseconds / 1000;
+        milliseconds %= 1000;
+
+        log << "Duration: " << seconds << ":" << milliseconds << std::endl;
+    }
+}
+
+Outcome PuzzleAlgorithm::processPuzzle(std::string_view puzzle, std::ostream& out, const std::string& name, bool many, std::ostream& err)
+{
+    Outcome result = Outcome::SOLVED;
+    auto start = std::chrono::steady_clock::now();
+    SolutionCache::Key key;
+    if (cache) {
+        std::string_view cached;
+        key = SolutionCache::keyOf(getName(), getVersion(), puzzle);
+        if (cache->find(key, cached)) {
+            out << cached;
+            summary.record(result, elapsedSince(start));
+            return result;
+        }
+    }
+    cancellation.start(timeout);
+    try {
+        if (cache) {
+            // Only complete results of solved puzzles are stored
+            std::ostringstream solution;
+            processFile(puzzle, solution);
+            if (isSolved()) cache->store(key, solution.str());
+            out << solution.str();
+        }
+        else processFile(puzzle, out);
+    }
+    catch (...) {
+        result = reportFailure(std::current_exception(), out, name, many, err);
+    }
+    summary.record(result, elapsedSince(start));
+    cleanUp();
+    arena.reset();
+    return result;
+}
+
+void PuzzleAlgorithm::processFile(std::string_view input, std::ostream& outFile)
+{
+    parse(input);
+    solve();
+    format(outFile);
+}
+
+bool PuzzleAlgorithm::isSolved()
+{
+    return true;
+}
+
+void PuzzleAlgorithm::reportCounters(PuzzleAlgorithm& algorithm, const std::string& name, std::ostream& log)
+{
+    if (Counter::enabled) {
+        log << "Stats " << name << ": ";
+        algorithm.counters.print(log);
+        log << std::endl;
+    }
+    algorithm.counters.addTo(counterTotals);
+    algorithm.counters.reset();
+}
+
+Outcome PuzzleAlgorithm::reportFailure(std::exception_ptr error, std::ostream& out, const std::string& name, bool many, std::ostream& err)
+{
+    try {
+        std::rethrow_exception(error);
+    }
+    catch (const WrongFileFormatException& e) {
+        err << "Wrong file format: " << name << std::endl;
+        if (many) out << "Wrong format\n";
+        return Outcome::WRONG_FORMAT;
+    }
+    catch (const NoSolutionException& e) {
+        err << "No solution: " << name << std::endl;
+        if (many) out << "No solutions\n";
+        return Outcome::NO_SOLUTION;
+    }
+    catch (const TimeoutException& e) {
+        err << "Timeout: " << name << std::endl;
+        if (many) out << "Timeout\n";
+        return Outcome::TIMEOUT;
+    }
+    catch (const std::exception & e) {
+        err << "Failed process file: " << name << std::endl;
+        err << e.what() << std::endl;
+        if (many) out << "Error\n";
+    }
+    return Outcome::FAILED;
 }
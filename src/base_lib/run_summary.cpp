@@ -0,0 +1,116 @@
+#include <base-lib.h>
+
+#include <iomanip>
+#include <sstream>
+
+using namespace baselib;
+
+// Percentiles included in the summary, with their printed names and names in JSON
+static const double percentiles[] = { 50, 90, 99, 99.9 };
+static const char* const percentileLabels[] = { "p50", "p90", "p99", "p99.9" };
+static const char* const percentileNames[] = { "p50", "p90", "p99", "p99_9" };
+
+RunSummary::RunSummary() : startTime(std::chrono::steady_clock::now()), wallTime(0) { }
+
+void RunSummary::start()
+{
+	for (LatencyHistogram& histogram : latencies) histogram.clear();
+	startTime = std::chrono::steady_clock::now();
+	wallTime = 0;
+}
+
+void RunSummary::stop()
+{
+	wallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+LatencyHistogram RunSummary::total() const
+{
+	LatencyHistogram result;
+	for (const LatencyHistogram& histogram : latencies) result.merge(histogram);
+	return result;
+}
+
+const char* RunSummary::nameOf(Outcome outcome)
+{
+	switch (outcome) {
+	case Outcome::SOLVED: return "solved";
+	case Outcome::NO_SOLUTION: return "no_solution";
+	case Outcome::WRONG_FORMAT: return "wrong_format";
+	case Outcome::TIMEOUT: return "timeout";
+	case Outcome::FAILED: return "failed";
+	default: return "";
+	}
+}
+
+/**
+* Formats nanoseconds with three significant digits in the most readable unit.
+*/
+static std::string formatDuration(std::uint64_t nanoseconds)
+{
+	static const char* const units[] = { "ns", "us", "ms", "s" };
+	double value = (double)nanoseconds;
+	int unit = 0;
+	while (value >= 1000 && unit < 3) {
+		value /= 1000;
+		unit++;
+	}
+	std::ostringstream o;
+	o << std::setprecision(3) << value << " " << units[unit];
+	return o.str();
+}
+
+static void printLatencies(std::ostream& o, const LatencyHistogram& histogram)
+{
+	for (int i = 0; i < 4; i++) {
+		o << percentileLabels[i] << " " << formatDuration(histogram.percentile(percentiles[i])) << ", ";
+	}
+	o << "max " << formatDuration(histogram.max());
+}
+
+static void printJsonLatencies(std::ostream& o, const LatencyHistogram& histogram)
+{
+	o << "{\"min\":" << histogram.min() << ",\"mean\":" << (std::uint64_t)histogram.mean();
+	for (int i = 0; i < 4; i++) {
+		o << ",\"" << percentileNames[i] << "\":" << histogram.percentile(percentiles[i]);
+	}
+	o << ",\"max\":" << histogram.max() << "}";
+}
+
+void RunSummary::print(std::ostream& o) const
+{
+	LatencyHistogram all = total();
+	double seconds = wallTime / 1e9;
+	o << "Summary: " << all.count() << " puzzles in " << formatDuration(wallTime);
+	if (seconds > 0) o << ", " << std::setprecision(4) << all.count() / seconds << " puzzles/s";
+	o << std::endl;
+	if (all.count() == 0) return;
+	o << "Latency: ";
+	printLatencies(o, all);
+	o << std::endl;
+	for (int i = 0; i < (int)Outcome::COUNT; i++) {
+		const LatencyHistogram& histogram = latencies[i];
+		if (histogram.count() == 0) continue;
+		o << "  " << nameOf((Outcome)i) << ": " << histogram.count() << ", ";
+		printLatencies(o, histogram);
+		o << std::endl;
+	}
+}
+
+void RunSummary::printJson(std::ostream& o) const
+{
+	LatencyHistogram all = total();
+	double seconds = wallTime / 1e9;
+	o << "{\"puzzles\":" << all.count() << ",\"wall_ns\":" << wallTime
+		<< ",\"puzzles_per_second\":" << std::setprecision(6) << (seconds > 0 ? all.count() / seconds : 0)
+		<< ",\"latency_ns\":";
+	printJsonLatencies(o, all);
+	o << ",\"outcomes\":{";
+	for (int i = 0; i < (int)Outcome::COUNT; i++) {
+		if (i > 0) o << ",";
+		o << "\"" << nameOf((Outcome)i) << "\":{\"count\":" << latencies[i].count() << ",\"latency_ns\":";
+		printJsonLatencies(o, latencies[i]);
+		o << "}";
+	}
+	o << "}}" << std::endl;
+}
@@ -0,0 +1,139 @@
+#include <base-lib.h>
+
+#include <cstring>
+
+using namespace baselib;
+namespace fs = std::filesystem;
+
+// Beginning of every cache file
+static const char magic[8] = { 'P', 'Z', 'C', 'A', 'C', 'H', 'E', '1' };
+
+namespace {
+    // Entry header in the file, followed by length bytes of the result
+    struct EntryHeader {
+        std::uint64_t low;
+        std::uint64_t high;
+        std::uint64_t length;
+    };
+
+    std::uint64_t mix(std::uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    // Two independent FNV-1a style lanes, finished with the splitmix64 mix
+    class KeyHasher {
+    private:
+        std::uint64_t low = 0xcbf29ce484222325ULL;
+        std::uint64_t high = 0x84222325cbf29ce4ULL;
+    public:
+        void add(std::string_view text)
+        {
+            for (unsigned char c : text) {
+                low = (low ^ c) * 0x100000001b3ULL;
+                high = (high ^ c) * 0x9e3779b97f4a7c15ULL;
+            }
+        }
+        void add(char c) { add(std::string_view(&c, 1)); }
+        SolutionCache::Key get() const { return SolutionCache::Key{ mix(low), mix(high ^ low) }; }
+    };
+}
+
+SolutionCache::SolutionCache(const std::string& path) : hits(0), misses(0)
+{
+    std::uint64_t validSize = sizeof(magic);
+    if (fs::exists(path) && fs::file_size(path) > 0) {
+        mapped = std::make_unique<MappedFile>(path);
+        if (!mapped->isOpen()) throw std::runtime_error("Failed to open cache file: " + path);
+        std::string_view data = mapped->view();
+        if (data.size() < sizeof(magic) || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("Not a cache file: " + path);
+        }
+
+        validSize = indexEntries();
+        if (validSize < data.size()) {
+            // The mapping is released before the file is truncated, then the index is rebuilt from a new one
+            index.clear();
+            mapped.reset();
+            fs::resize_file(path, validSize);
+            mapped = std::make_unique<MappedFile>(path);
+            if (!mapped->isOpen()) throw std::runtime_error("Failed to open cache file: " + path);
+            indexEntries();
+        }
+        log.open(path, std::ios::binary | std::ios::app);
+    }
+    else {
+        log.open(path, std::ios::binary | std::ios::trunc);
+        log.write(magic, sizeof(magic));
+        log.flush();
+    }
+    if (!log) throw std::runtime_error("Failed to open cache file: " + path);
+}
+
+std::size_t SolutionCache::indexEntries()
+{
+    std::string_view data = mapped->view();
+    std::size_t position = sizeof(magic);
+    EntryHeader header;
+    while (data.size() - position >= sizeof(header)) {
+        std::memcpy(&header, data.data() + position, sizeof(header));
+        if (header.length > data.size() - position - sizeof(header)) break;
+        position += sizeof(header);
+        index[Key{ header.low, header.high }] = data.substr(position, header.length);
+        position += header.length;
+    }
+    return position;
+}
+
+SolutionCache::Key SolutionCache::keyOf(const std::string& algorithm, int version, std::string_view puzzle)
+{
+    KeyHasher hasher;
+    hasher.add(algorithm);
+    hasher.add('\0');
+    hasher.add(std::to_string(version));
+    hasher.add('\0');
+
+    TextReader reader(puzzle);
+    std::string_view line;
+    while (reader.readLine(line)) {
+        if (line.empty()) continue;
+        hasher.add(line);
+        hasher.add('\n');
+    }
+    return hasher.get();
+}
+
+bool SolutionCache::find(const Key& key, std::string_view& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    result = it->second;
+    return true;
+}
+
+void SolutionCache::store(const Key& key, std::string_view result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.find(key) != index.end()) return;
+
+    EntryHeader header{ key.low, key.high, result.size() };
+    log.write((const char*)&header, sizeof(header));
+    log.write(result.data(), result.size());
+    log.flush();
+
+    added.emplace_back(result);
+    index[key] = added.back();
+}
+
+std::size_t SolutionCache::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
@@ -0,0 +1,362 @@
+#include <base-lib.h>
+
+#include <deque>
+#include <sstream>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#define BASELIB_SOCKETS
+#endif
+
+using namespace baselib;
+
+// Longest accepted puzzle text, a longer request closes the connection
+static const std::size_t maxRequestLength = 64 * 1024 * 1024;
+// Requests of one connection read but not yet answered. When there are this many, no more are read until a response is sent,
+// so a client that does not read its responses is slowed down by the socket instead of filling the memory of the server
+static const std::size_t maxPendingRequests = 64;
+
+namespace {
+    // One request of a connection, completed by a worker thread
+    struct Request {
+        int algorithm;
+        std::string puzzle;
+        std::string outcome;
+        std::string result;
+        bool done = false;
+    };
+
+#ifdef BASELIB_SOCKETS
+    // Buffered reading of lines and blocks from a socket
+    class SocketReader {
+    private:
+        int socket;
+        std::string buffer;
+        std::size_t position;
+
+        bool fill()
+        {
+            if (position > 0) {
+                buffer.erase(0, position);
+                position = 0;
+            }
+            char chunk[65536];
+            ssize_t count = recv(socket, chunk, sizeof(chunk), 0);
+            if (count <= 0) return false;
+            buffer.append(chunk, count);
+            return true;
+        }
+    public:
+        SocketReader(int socket) : socket(socket), position(0) { }
+
+        bool readLine(std::string& line)
+        {
+            std::size_t end;
+            while ((end = buffer.find('\n', position)) == std::string::npos) {
+                if (buffer.size() - position > 4096 || !fill()) return false;
+            }
+            line.assign(buffer, position, end - position);
+            position = end + 1;
+            return true;
+        }
+
+        bool read(std::string& result, std::size_t length)
+        {
+            while (buffer.size() - position < length) {
+                if (!fill()) return false;
+            }
+            result.assign(buffer, position, length);
+            position += length;
+            return true;
+        }
+    };
+
+    bool sendAll(int socket, const std::string& data)
+    {
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        flags = MSG_NOSIGNAL;
+#endif
+        std::size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t count = send(socket, data.data() + sent, data.size() - sent, flags);
+            if (count <= 0) return false;
+            sent += count;
+        }
+        return true;
+    }
+
+    // Pipe through which the signal handler of runUntilSignal wakes the thread stopping the server
+    int signalPipe[2] = { -1, -1 };
+
+    void onSignal(int)
+    {
+        char message = 1;
+        ssize_t written = write(signalPipe[1], &message, 1);
+        (void)written;
+    }
+#endif
+}
+
+struct SolverServer::Connection {
+    int socket;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::shared_ptr<Request>> pending;
+    // Set when the client stopped sending requests
+    bool finished = false;
+};
+
+SolverServer::SolverServer(const std::vector<std::shared_ptr<PuzzleAlgorithm>>& algorithms, int workers, std::chrono::nanoseconds timeout)
+    : algorithms(algorithms), idle(algorithms.size()), pool(workers), listenSocket(-1), stopping(false)
+{
+    // Instances are created up front, so the first requests do not pay for it
+    for (std::size_t i = 0; i < algorithms.size(); i++) {
+        for (int worker = 0; worker < pool.size(); worker++) {
+            std::shared_ptr<PuzzleAlgorithm> instance = algorithms[i]->clone();
+            instance->setTimeout(timeout);
+            instance->setCache(algorithms[i]->getCache());
+            idle[i].push_back(instance);
+        }
+    }
+}
+
+SolverServer::~SolverServer()
+{
+    stop();
+}
+
+std::shared_ptr<PuzzleAlgorithm> SolverServer::acquire(int algorithm)
+{
+    // There are as many instances as worker threads, so one is always idle
+    std::lock_guard<std::mutex> lock(idleMutex);
+    std::shared_ptr<PuzzleAlgorithm> instance = idle[algorithm].back();
+    idle[algorithm].pop_back();
+    return instance;
+}
+
+void SolverServer::release(int algorithm, std::shared_ptr<PuzzleAlgorithm> instance)
+{
+    std::lock_guard<std::mutex> lock(idleMutex);
+    idle[algorithm].push_back(instance);
+}
+
+#ifdef BASELIB_SOCKETS
+
+void SolverServer::run(const std::string& socketPath)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + socketPath);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) throw std::runtime_error("Failed to create socket");
+    unlink(socketPath.c_str());
+    if (bind(server, (sockaddr*)&address, sizeof(address)) != 0 || listen(server, 64) != 0) {
+        close(server);
+        throw std::runtime_error("Failed to listen on socket: " + socketPath);
+    }
+    {
+        // stop() called before this point has already set stopping, after it the socket is shut down by stop()
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        listenSocket = server;
+    }
+
+    while (!stopping) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) continue;
+        {
+            // A client accepted while stop() runs is either seen by it or sees stopping here
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            if (stopping) {
+                close(client);
+                break;
+            }
+            connections.push_back(client);
+        }
+        std::thread(&SolverServer::serveConnection, this, client).detach();
+    }
+
+    // Wait for the connection threads, which use the worker pool and the instances
+    std::unique_lock<std::mutex> lock(connectionsMutex);
+    close(listenSocket);
+    listenSocket = -1;
+    connectionsClosed.wait(lock, [this]() { return connections.empty(); });
+    unlink(socketPath.c_str());
+}
+
+void SolverServer::runUntilSignal(const std::string& socketPath)
+{
+    if (pipe(signalPipe) != 0) throw std::runtime_error("Failed to create signal pipe");
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct sigaction previousInterrupt;
+    struct sigaction previousTerminate;
+    sigaction(SIGINT, &action, &previousInterrupt);
+    sigaction(SIGTERM, &action, &previousTerminate);
+
+    // The handler only writes to the pipe, stop() is called from this thread. A 0 written after run() returns ends it
+    std::thread watcher([this]() {
+        char message = 0;
+        while (read(signalPipe[0], &message, 1) < 0 && errno == EINTR) { }
+        if (message == 1) stop();
+    });
+
+    std::exception_ptr error;
+    try {
+        run(socketPath);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    char message = 0;
+    ssize_t written = write(signalPipe[1], &message, 1);
+    (void)written;
+    watcher.join();
+    sigaction(SIGINT, &previousInterrupt, nullptr);
+    sigaction(SIGTERM, &previousTerminate, nullptr);
+    close(signalPipe[0]);
+    close(signalPipe[1]);
+    signalPipe[0] = signalPipe[1] = -1;
+    if (error) std::rethrow_exception(error);
+}
+
+void SolverServer::stop()
+{
+    stopping = true;
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    // Wakes up accept in run(), which closes the socket
+    if (listenSocket >= 0) shutdown(listenSocket, SHUT_RDWR);
+    // Writing is also shut down, so a writer blocked on a client that does not read its responses is released
+    for (int client : connections) shutdown(client, SHUT_RDWR);
+}
+
+void SolverServer::serveConnection(int socket)
+{
+    std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+    connection->socket = socket;
+    std::thread writer(&SolverServer::writeResponses, this, connection);
+
+    SocketReader reader(socket);
+    std::string header;
+    while (reader.readLine(header)) {
+        if (!header.empty() && header.back() == '\r') header.pop_back();
+        if (header.empty()) continue;
+
+        std::istringstream fields(header);
+        std::string name;
+        long long length = -1;
+        if (!(fields >> name >> length) || length < 0 || (std::size_t)length > maxRequestLength) break;
+
+        {
+            std::unique_lock<std::mutex> lock(connection->mutex);
+            connection->changed.wait(lock, [&connection]() { return connection->pending.size() < maxPendingRequests; });
+        }
+
+        std::shared_ptr<Request> request = std::make_shared<Request>();
+        if (!reader.read(request->puzzle, (std::size_t)length)) break;
+
+        request->algorithm = -1;
+        for (std::size_t i = 0; i < algorithms.size(); i++) {
+            if (algorithms[i]->getName() == name) request->algorithm = (int)i;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            connection->pending.push_back(request);
+            if (request->algorithm < 0) {
+                request->outcome = "unknown_algorithm";
+                request->done = true;
+                connection->changed.notify_all();
+            }
+        }
+        if (request->algorithm < 0) continue;
+
+        pool.submit([this, connection, request]() {
+            std::shared_ptr<PuzzleAlgorithm> instance = acquire(request->algorithm);
+            std::ostringstream result;
+            Outcome outcome = instance->solvePuzzle(request->puzzle, result);
+            release(request->algorithm, instance);
+
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            request->outcome = RunSummary::nameOf(outcome);
+            request->result = result.str();
+            request->puzzle.clear();
+            request->done = true;
+            connection->changed.notify_all();
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        connection->finished = true;
+        connection->changed.notify_all();
+    }
+    writer.join();
+    close(socket);
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    connections.erase(std::find(connections.begin(), connections.end(), socket));
+    connectionsClosed.notify_all();
+}
+
+void SolverServer::writeResponses(std::shared_ptr<Connection> connection)
+{
+    bool open = true;
+    while (true) {
+        std::shared_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(connection->mutex);
+            connection->changed.wait(lock, [&connection]() {
+                return (!connection->pending.empty() && connection->pending.front()->done) || (connection->finished && connection->pending.empty());
+            });
+            if (connection->pending.empty()) return;
+            request = connection->pending.front();
+            connection->pending.pop_front();
+            // The reader may wait for a free place in the queue
+            connection->changed.notify_all();
+        }
+        // After a failed write the remaining responses are only drained
+        if (open) {
+            std::string response = request->outcome + " " + std::to_string(request->result.size()) + "\n" + request->result;
+            open = sendAll(connection->socket, response);
+            if (!open) shutdown(connection->socket, SHUT_RD);
+        }
+    }
+}
+
+#else
+
+void SolverServer::run(const std::string& socketPath)
+{
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+}
+
+void SolverServer::runUntilSignal(const std::string& socketPath)
+{
+    run(socketPath);
+}
+
+void SolverServer::stop()
+{
+    stopping = true;
+}
+
+void SolverServer::serveConnection(int socket) { }
+
+void SolverServer::writeResponses(std::shared_ptr<Connection> connection) { }
+
+#endif
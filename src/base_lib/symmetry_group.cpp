@@ -0,0 +1,16 @@
+#include <base-lib.h>
+
+using namespace baselib;
+
+SymmetryGroup::SymmetryGroup(int width, int height, const std::vector<Index>& pattern, int stride)
+    : patternSize((int)pattern.size()), stride(stride), indexes(count * pattern.size()), offsets(count * pattern.size())
+{
+    for (int symmetry = 0; symmetry < count; symmetry++) {
+        transforms.push_back(IndexTransform(width, height, symmetry >= 4, false, symmetry % 4));
+        Index* out = indexes.data() + symmetry * patternSize;
+        transforms.back().transform(pattern.data(), out, patternSize);
+        for (int i = 0; i < patternSize; i++) {
+            offsets[symmetry * patternSize + i] = out[i].y * stride + out[i].x;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include <base-lib.h>
+
+using namespace baselib;
+
+TextReader::TextReader(std::string_view text)
+	: text(text), position(0), stream(nullptr), groupBegin(nullptr), groupEnd(nullptr) { }
+
+TextReader::TextReader(std::istream& stream)
+	: position(0), stream(&stream), groupBegin(nullptr), groupEnd(nullptr) { }
+
+bool TextReader::readLine(std::string_view& result)
+{
+	if (stream) {
+		if (!std::getline(*stream, line)) return false;
+		result = line;
+	}
+	else {
+		if (position >= text.size()) return false;
+		std::size_t end = text.find('\n', position);
+		if (end == std::string_view::npos) end = text.size();
+		result = text.substr(position, end - position);
+		position = end + 1;
+	}
+	if (!result.empty() && result.back() == '\r') result.remove_suffix(1);
+	return true;
+}
+
+std::string_view TextReader::readAll()
+{
+	if (stream) {
+		group.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+		return group;
+	}
+	std::string_view result = position < text.size() ? text.substr(position) : std::string_view();
+	position = text.size();
+	return result;
+}
+
+void TextReader::startGroup()
+{
+	group.clear();
+	groupBegin = nullptr;
+	groupEnd = nullptr;
+}
+
+void TextReader::addToGroup(std::string_view line)
+{
+	if (stream) {
+		group += line;
+		group += '\n';
+	}
+	else {
+		// Lines of the group follow each other in the text, so the group is the range from the first to the last one
+		if (groupBegin == nullptr) groupBegin = line.data();
+		groupEnd = line.data() + line.size();
+	}
+}
+
+std::string_view TextReader::getGroup() const
+{
+	if (stream) return group;
+	if (groupBegin == nullptr) return std::string_view();
+	return std::string_view(groupBegin, groupEnd - groupBegin);
+}
@@ -0,0 +1,118 @@
+#include <base-lib.h>
+
+#include <thread>
+#include <mutex>
+
+using namespace baselib;
+
+ThreadPool::ThreadPool(int threads) : activeTasks(0), stopping(false)
+{
+	if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 0; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(task));
+		activeTasks++;
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksDone.wait(lock, [this]() { return activeTasks == 0; });
+	if (error) {
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+}
+
+ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+
+		try {
+			task();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error) error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--activeTasks == 0) tasksDone.notify_all();
+	}
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool), pending(0) { }
+
+TaskGroup::~TaskGroup()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksDone.wait(lock, [this]() { return pending == 0; });
+}
+
+void TaskGroup::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending++;
+	}
+	// Errors are kept in the group, so they never reach the pool
+	pool.submit([this, task = std::move(task)]() {
+		std::exception_ptr taskError;
+		try {
+			task();
+		}
+		catch (...) {
+			taskError = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		if (taskError && !error) error = taskError;
+		if (--pending == 0) tasksDone.notify_all();
+	});
+}
+
+void TaskGroup::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksDone.wait(lock, [this]() { return pending == 0; });
+	if (error) {
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+}
@@ -10,9 +10,15 @@
 using namespace std;
 using namespace algorithms::signpost;
 
-Algorithm::Algorithm() { }
+Algorithm::Algorithm() {
+	counters.add("searchPath", searchNodes);
+}
 Algorithm::~Algorithm() { }
 
+shared_ptr<PuzzleAlgorithm> Algorithm::clone() const {
+	return make_shared<Algorithm>();
+}
+
 string Algorithm::getName() {
 	return "signpost";
 }
@@ -30,10 +36,11 @@ void Algorithm::printFormat(ostream& o) {
 		"rt rt rt t e25\n\n";
 }
 
-void Algorithm::prepare(std::ifstream& in) {
-	string line;
-	vector<string> lines;
-	while (getline(in, line)) {
+void Algorithm::prepare(std::string_view input) {
+	TextReader reader(input);
+	string_view line;
+	lines.clear();
+	while (reader.readLine(line)) {
 		if (!line.empty()) lines.push_back(line);
 	}
 
@@ -46,14 +53,21 @@ void Algorithm::prepare(std::ifstream& in) {
 
 	int lastIndex = width * height - 1;
 
+	linkHash.set(0);
+
+	// Nodes are reused between files, so their vectors keep the memory allocated for the previous puzzle
+	nodes.resize(width * height);
+
 	for (int y = 0; y < height; y++) {
 		line = lines[y];
 		auto it = line.begin();
 		for (int x = 0; x < width; x++) {
-			Node node;
+			Node& node = nodes[y * width + x];
 			node.order = 0;
 			node.nextNode = -1;
 			node.prevNode = -1;
+			node.next.clear();
+			node.prev.clear();
 			Index direction;
 			while (it != line.end() && *it != ' ' && *it != '\n') {
 				if (*it == 'l') direction.x = -1;
@@ -79,7 +93,6 @@ void Algorithm::prepare(std::ifstream& in) {
 					hook = hook + direction;
 				}
 			}
-			nodes.push_back(node);
 		}
 	}
 
@@ -90,23 +103,35 @@ void Algorithm::prepare(std::ifstream& in) {
 	}
 }
 
-void Algorithm::processFile(ifstream& inFile, ofstream& outFile) {
-	prepare(inFile);
+void Algorithm::parse(string_view input) {
+	prepare(input);
 	prepareRanges();
+}
 
+void Algorithm::solve() {
 	mainLoop();
+}
 
+void Algorithm::format(ostream& outFile) {
 	outFile << (*this);
 }
 
+bool Algorithm::isSolved() {
+	for (const Node& node : nodes) {
+		if (node.order == -1) return false;
+	}
+	return true;
+}
+
 void Algorithm::cleanUp() {
-	nodes.clear();
 	ranges.clear();
 }
 
 void Algorithm::mainLoop() {
 	do {
 		do {
+			// A pass goes over the whole graph, so the deadline is checked after each one
+			cancellation.checkNow();
 			updateFlag = false;
 			simplifyGraph();
 			connectRanges();
@@ -134,6 +159,7 @@ void Algorithm::connect(int prev, int next)
 	// setup nodes
 	
 	nodes[prev].nextNode = next;
+	linkHash.toggle(prev, next + 1);
 	nodes[next].prevNode = prev;
 
 	// Removes all other connections
@@ -253,6 +279,7 @@ void Algorithm::prepareRanges()
 
 		if (range.endOrder + 1 == n->order) {
 			prevNode->nextNode = i;
+			linkHash.toggle(prevNodeIndex, i + 1);
 			n->prevNode = prevNodeIndex;
 			range.endOrder = n->order;
 			range.endNode = i;
@@ -311,6 +338,8 @@ void Algorithm::connectRanges()
 
 void Algorithm::searchPath(vector<vector<int>>& solutions, vector<int>& currentSolution, vector<bool>& visited, int node, int order, int targetNode, int targetOrder)
 {
+	++searchNodes;
+	cancellation.check();
 	if (order >= targetOrder) return;
 	if (order == targetOrder - 1) {
 		for (int nd : nodes[node].next) {
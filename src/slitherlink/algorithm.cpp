@@ -14,41 +14,40 @@
 using namespace algorithms::slitherlink;
 using namespace std;
 
-ColorBoard::ColorBoard(int width, int height) : Board(width, height), colorMargin(1), nextColor(2), updateFlag(false) {
-    for (int y = 0; y < height; y++)
-        for (int x = 0; x < width; x++) {
-            tab[x][y] = 0;
-        }
+ColorBoard::ColorBoard(int width, int height, Arena* arena) : Board(width, height, 1, 1, arena), classes(2), trail(nullptr), merges(nullptr), updateFlag(false) {
+    fill(0);
+    // Each new color is given to at least one field without a color, so there are never more colors than fields
+    classes.reserve(width * height + 2);
 }
 
-void ColorBoard::colorSame(vector<Index> indexes, vector<Index> oposite = vector<Index>())
+void ColorBoard::colorSame(const Neighbours& indexes, const Neighbours& oposite)
 {
     // First check how many color are in passed indexes.
-    set<int> group;
+    int group[16];
+    int groupSize = 0;
     bool anyChange = false;
-    for (const Index& idx : indexes) {
-        int color = (*this)[idx];
-        group.insert(color);
-    }
-    for (const Index& idx : oposite) {
-        int color = (*this)[idx];
-        group.insert(-color);
-    }
-    const auto it = group.find(0);
-    if (it != group.end()) {
-        group.erase(it);
-        anyChange = true;
-    }
+    auto addColor = [&](int color) {
+        if (color == 0) {
+            anyChange = true;
+            return;
+        }
+        for (int i = 0; i < groupSize; i++) {
+            if (group[i] == color) return;
+        }
+        group[groupSize++] = color;
+    };
+    for (const Index& idx : indexes) addColor((*this)[idx]);
+    for (const Index& idx : oposite) addColor(-(*this)[idx]);
     int targetColor;
 
-    if (group.empty()) {
-        targetColor = nextColor++;
+    if (groupSize == 0) {
+        targetColor = classes.add();
     }
-    else if (group.size() == 1) {
-        targetColor = *group.begin();
+    else if (groupSize == 1) {
+        targetColor = group[0];
     }
     else {
-        targetColor = mergeColors(group);
+        targetColor = mergeColors(group, groupSize);
         anyChange = true;
     }
 
@@ -56,29 +55,28 @@ void ColorBoard::colorSame(vector<Index> indexes, vector<Index> oposite = vector
 
     updateFlag = true;
     for (const Index& idx : indexes) {
-        (*this)[idx] = targetColor;
+        write(tab[offset(idx)], targetColor);
     }
     for (const Index& idx : oposite) {
-        (*this)[idx] = -targetColor;
+        write(tab[offset(idx)], -targetColor);
     }
 }
 
-int ColorBoard::mergeColors(const set<int>& colors)
+int ColorBoard::mergeColors(const int* colors, int count)
 {
-    int minimumColor = numeric_limits<int>::max();
-    for (auto it = colors.begin(); it != colors.end(); it++) {
-        if ((abs(*it)) < abs(minimumColor)) minimumColor = *it;
-        else break;
+    if (merges) ++*merges;
+    // Of a color and its opposite the negative one is chosen
+    int minimumColor = colors[0];
+    for (int i = 1; i < count; i++) {
+        int color = colors[i];
+        if (abs(color) < abs(minimumColor) || (abs(color) == abs(minimumColor) && color < minimumColor)) minimumColor = color;
     }
 
-    set<int> c(colors);
-    c.erase(minimumColor);
-
-    for (int x = 0; x < getWidth(); x++) {
-        for (int y = 0; y < getHeight(); y++) {
-            int& fieldValue = tab[x][y];
-            if (c.contains(fieldValue)) fieldValue = minimumColor;
-            else if (c.contains(-fieldValue)) fieldValue = -minimumColor;
+    for (int i = 0; i < count; i++) {
+        int color = colors[i];
+        if (color == minimumColor) continue;
+        if (!classes.unite(abs(color), abs(minimumColor), (color < 0) != (minimumColor < 0))) {
+            throw NoSolutionException();
         }
     }
 
@@ -87,13 +85,11 @@ int ColorBoard::mergeColors(const set<int>& colors)
 
 void ColorBoard::normalizeColors()
 {
+    forEachMutable([this](Index, int& value) { write(value, colorOf(value)); });
+    classes.reset(classes.size());
+
     set<int> colors;
-    int w = getWidth();
-    int h = getHeight();
-    for (int x = 0; x < w; x++)
-        for (int y = 0; y < h; y++) {
-            colors.insert(abs(tab[x][y]));
-        }
+    forEach([&colors](Index, int value) { colors.insert(abs(value)); });
     int num = 2;
     auto it = colors.begin();
     auto rit = colors.rbegin();
@@ -105,42 +101,16 @@ void ColorBoard::normalizeColors()
         if (it != colors.end() && *it <= *rit) {
             int from = *rit;
             int to = num;
-            for (int x = 0; x < w; x++)
-                for (int y = 0; y < h; y++) {
-                    if (tab[x][y] == from) tab[x][y] = to;
-                    if (tab[x][y] == -from) tab[x][y] = -to;
-                }
+            forEachMutable([this, from, to](Index, int& value) {
+                if (value == from) write(value, to);
+                if (value == -from) write(value, -to);
+            });
             *rit++;
             num++;
         }
     }
 }
 
-int& ColorBoard::operator[](const Index& idx)
-{
-	if (inRange(idx)) {
-		return tab[idx.x][idx.y];
-	}
-	return colorMargin;
-}
-
-const int& ColorBoard::operator[](const Index& idx) const
-{
-	if (inRange(idx)) {
-		return tab[idx.x][idx.y];
-	}
-    return colorMargin;
-}
-
-int* ColorBoard::operator[](const int& x)
-{
-    return tab[x];
-}
-
-const int* ColorBoard::operator[](const int& x) const
-{
-    return tab[x];
-}
 
 ostream& algorithms::slitherlink::operator<<(ostream& os, const ColorBoard& board)
 {
@@ -150,7 +120,7 @@ ostream& algorithms::slitherlink::operator<<(ostream& os, const ColorBoard& boar
 
     for (int x = 0; x < width; x++) {
         for (int y = 0; y < height; y++) {
-            int value = board.tab[x][y];
+            int value = board[Index(x, y)];
             size_t numDigits = (value == 0) ? 2 : to_string(abs(value)).length() + 1;
             colWidths[x] = max(colWidths[x], numDigits);
         }
@@ -159,7 +129,7 @@ ostream& algorithms::slitherlink::operator<<(ostream& os, const ColorBoard& boar
     for (int y = 0; y < height; ++y) {
         os << "| ";
         for (int x = 0; x < width; ++x) {
-            int value = board.tab[x][y];
+            int value = board[Index(x, y)];
             string sign = (value > 0) ? "+" : "";
             if (value == 0) {
                 os << std::string(colWidths[x], '-');
@@ -175,8 +145,20 @@ ostream& algorithms::slitherlink::operator<<(ostream& os, const ColorBoard& boar
     return os;
 }
 
-Algorithm::Algorithm() { }
-Algorithm::~Algorithm() { }
+Algorithm::Algorithm() : colorBoard(nullptr), numbers(nullptr), crosses(nullptr), diagonalThrees(nullptr), rowThrees(nullptr)
+{
+    counters.add("countNeighbours", countNeighboursSteps);
+    counters.add("checkCrosses", checkCrossesSteps);
+    counters.add("expandAreas", expandAreasSteps);
+    counters.add("mergeColors", mergeColorsCalls);
+}
+Algorithm::~Algorithm()
+{
+    delete crosses;
+    delete diagonalThrees;
+    delete rowThrees;
+}
+shared_ptr<PuzzleAlgorithm> Algorithm::clone() const { return make_shared<Algorithm>(); }
 std::string Algorithm::getName() { return "slitherlink"; }
 
 void Algorithm::printFormat(ostream& o)
@@ -187,11 +169,12 @@ void Algorithm::printFormat(ostream& o)
 	o << "21-2\n---2\n-3-1\n3-22\n\n";
 }
 
-void Algorithm::processFile(ifstream& inFile, ofstream& outFile)
+void Algorithm::parse(string_view input)
 {
-    string line;
-    vector<string> lines;
-    while (std::getline(inFile, line)) {
+    TextReader reader(input);
+    string_view line;
+    lines.clear();
+    while (reader.readLine(line)) {
         if (!line.empty()) lines.push_back(line);
     }
     if (lines.size() == 0) {
@@ -200,9 +183,24 @@ void Algorithm::processFile(ifstream& inFile, ofstream& outFile)
     
     int width = lines[0].size();
     int height = lines.size();
+    for (const string_view& l : lines) {
+        if ((int)l.size() < width) throw WrongFileFormatException();
+    }
     
-    numbers = new Board<int>(width, height);
-    colorBoard = new ColorBoard(width, height);
+    numbers = arena.create<Board<int>>(width, height, 0, 0, &arena);
+    colorBoard = arena.create<ColorBoard>(width, height, &arena);
+    colorBoard->setMergeCounter(&mergeColorsCalls);
+    if (crosses == nullptr || crosses->getStride() != colorBoard->getStride()) {
+        delete crosses;
+        crosses = new SymmetryGroup(2, 2, { Index(0, 0), Index(0, 1), Index(1, 0), Index(1, 1) }, colorBoard->getStride());
+    }
+    if (diagonalThrees == nullptr || diagonalThrees->getStride() != numbers->getStride()) {
+        delete diagonalThrees;
+        delete rowThrees;
+        diagonalThrees = new SymmetryGroup(2, 2, { Index(0, 0), Index(1, 1), Index(-1, 0), Index(0, -1), Index(2, 1), Index(1, 2) }, numbers->getStride());
+        rowThrees = new SymmetryGroup(2, 1, { Index(0, 0), Index(1, 0), Index(-1, 0), Index(2, 0), Index(0, -1), Index(1, -1), Index(0, 1), Index(1, 1) },
+            numbers->getStride());
+    }
 
     char c;
     for (int y = 0; y < height; y++) {
@@ -212,17 +210,36 @@ void Algorithm::processFile(ifstream& inFile, ofstream& outFile)
         }
     }
 
+}
+
+void Algorithm::solve()
+{
     findPatterns();
     mainLoop();
-    
+}
+
+void Algorithm::format(ostream& outFile)
+{
     // colorBoard->normalizeColors();
     // outFile << *colorBoard << endl;
     outFile << *this;
 }
 
+bool Algorithm::isSolved()
+{
+    bool solved = true;
+    colorBoard->forEach([this, &solved](Index, int value) {
+        if (abs(colorBoard->colorOf(value)) != 1) solved = false;
+    });
+    return solved;
+}
+
 void Algorithm::cleanUp()
 {
-    delete colorBoard;
+    // Both boards live in the arena, which is reset after this call
+    colorBoard = nullptr;
+    numbers = nullptr;
+    updateNumbers.clear();
 }
 
 void Algorithm::findPatterns()
@@ -230,50 +247,42 @@ void Algorithm::findPatterns()
     int w = numbers->getWidth();
     int h = numbers->getHeight();
 
-    // find 3 : 3 pattern in diagonal
-    vector<IndexTransform> transforms{ IndexTransform(2, 2), IndexTransform(2, 2, true) };
-    for (const auto& t : transforms) {
-        for (int x = 0; x < w - 1; x++) {
-            for (int y = 0; y < h - 1; y++) {
-                Index hook(x, y);
-                Index idx_num3_1 = Index(0, 0) * t + hook;
-                Index idx_num3_2 = Index(1, 1) * t + hook;
-                if ((*numbers)[idx_num3_1] != 3 || (*numbers)[idx_num3_2] != 3) continue;
-                Index idx_ne1_1 = Index(-1, 0) * t + hook;
-                Index idx_ne1_2 = Index(0, -1) * t + hook;
-                Index idx_ne2_1 = Index(2, 1) * t + hook;
-                Index idx_ne2_2 = Index(1, 2) * t + hook;
-                colorBoard->colorSame({ idx_num3_1 }, { idx_ne1_1, idx_ne1_2 });
-                colorBoard->colorSame({ idx_num3_2 }, { idx_ne2_1, idx_ne2_2 });
+    // Anchors at which both 3's of the pattern lie on the board. The other fields may lie in the margin of colorBoard.
+    auto forEachAnchor = [w, h](const Index* window, auto&& func) {
+        int firstX = -min(window[0].x, window[1].x);
+        int lastX = w - 1 - max(window[0].x, window[1].x);
+        int firstY = -min(window[0].y, window[1].y);
+        int lastY = h - 1 - max(window[0].y, window[1].y);
+        for (int x = firstX; x <= lastX; x++) {
+            for (int y = firstY; y <= lastY; y++) {
+                func(Index(x, y));
             }
         }
+    };
+
+    // find 3 : 3 pattern in diagonal, in both directions
+    for (int symmetry : { 0, 4 }) {
+        const Index* window = diagonalThrees->indexesOf(symmetry);
+        const int* offsets = diagonalThrees->offsetsOf(symmetry);
+        forEachAnchor(window, [&](Index hook) {
+            const int* field = &numbers->at(hook.x, hook.y);
+            if (field[offsets[0]] != 3 || field[offsets[1]] != 3) return;
+            colorBoard->colorSame({ hook + window[0] }, { hook + window[2], hook + window[3] });
+            colorBoard->colorSame({ hook + window[1] }, { hook + window[4], hook + window[5] });
+        });
     }
 
-    // find 3 : 3 pattern in row
-    vector<IndexTransform> transforms2{ IndexTransform(2, 1), IndexTransform(2, 1, false, false, 1) };
-    for (const auto& t : transforms2) {
-        for (int x = 0; x < w; x++) {
-            for (int y = 0; y < h; y++) {
-                Index hook(x, y);
-                Index idx_num3_1 = Index(0, 0) * t + hook;
-                Index idx_num3_2 = Index(1, 0) * t + hook;
-                try {
-                    if ((*numbers)[idx_num3_1] != 3 || (*numbers)[idx_num3_2] != 3) continue;
-                }
-                catch (const exception& e) {
-                    continue;
-                }
-                Index idx_num3_1b = Index(-1, 0) * t + hook;
-                Index idx_num3_2b = Index(2, 0) * t + hook;
-                Index idx_up1 = Index(0, -1) * t + hook;
-                Index idx_up2 = Index(1, -1) * t + hook;
-                Index idx_down1 = Index(0, 1) * t + hook;
-                Index idx_down2 = Index(1, 1) * t + hook;
-                colorBoard->colorSame({ idx_num3_1, idx_num3_2b }, { idx_num3_2, idx_num3_1b });
-                colorBoard->colorSame({ idx_up1, idx_up2 });
-                colorBoard->colorSame({ idx_down1, idx_down2 });
-            }
-        }
+    // find 3 : 3 pattern in row, horizontal and vertical
+    for (int symmetry : { 0, 1 }) {
+        const Index* window = rowThrees->indexesOf(symmetry);
+        const int* offsets = rowThrees->offsetsOf(symmetry);
+        forEachAnchor(window, [&](Index hook) {
+            const int* field = &numbers->at(hook.x, hook.y);
+            if (field[offsets[0]] != 3 || field[offsets[1]] != 3) return;
+            colorBoard->colorSame({ hook + window[0], hook + window[3] }, { hook + window[1], hook + window[2] });
+            colorBoard->colorSame({ hook + window[4], hook + window[5] });
+            colorBoard->colorSame({ hook + window[6], hook + window[7] });
+        });
     }
 
     // find 0, fill update numbers
@@ -282,7 +291,7 @@ void Algorithm::findPatterns()
             int num = (*numbers)[Index(x, y)];
             if (num == -1) continue;
             if (num == 0) {
-                auto indexes = Index(x, y).neighbours(true, false);
+                Neighbours indexes = Index(x, y).neighbours(true, false);
                 indexes.push_back(Index(x, y));
                 colorBoard->colorSame(indexes);
             }
@@ -295,36 +304,38 @@ void Algorithm::findPatterns()
 
 void Algorithm::mainLoop()
 {
-    int limit = 10000;
     do {
         do {
+            // A pass goes over the whole board, so the deadline is checked after each one
+            cancellation.checkNow();
             colorBoard->updateFlag = false;
 
             stepCountNeighbours();
+            ++countNeighboursSteps;
             stepCheckCrosses();
-
-            if (--limit == 0) {
-                cout << "LIMIT!" << endl;
-                break;
-            }
-
+            ++checkCrossesSteps;
         } while (colorBoard->updateFlag);
         
         stepExpandAreas();
+        ++expandAreasSteps;
     } while (colorBoard->updateFlag);
 }
 
 void Algorithm::stepCountNeighbours()
 {
-    vector<Index> toRemove;
-    for (const Index& hook : updateNumbers) {
+    // Numbers whose neighbourhood is fully colored are removed, the others are moved to the front of the list
+    size_t kept = 0;
+    for (size_t i = 0; i < updateNumbers.size(); i++) {
+        cancellation.check();
+        const Index hook = updateNumbers[i];
+        updateNumbers[kept++] = hook;
         int num = (*numbers)[hook];
         if (num == -1) continue;
         int color = (*colorBoard)[hook];
 
-        vector<Index> neighours = hook.neighbours(true, false);
-        vector<int> colors;
-        for (const Index& idx : neighours) colors.push_back((*colorBoard)[idx]);
+        Neighbours neighours = hook.neighbours(true, false);
+        int colors[4];
+        for (int i = 0; i < 4; i++) colors[i] = (*colorBoard)[neighours[i]];
 
         // Full known
         if (color != 0) {
@@ -337,23 +348,23 @@ void Algorithm::stepCountNeighbours()
 
             if (sameColorsCount + revColorsCount != 4) {
                 if (sameColorsCount == 4 - num) {
-                    vector<Index> rest;
+                    Neighbours rest;
                     for (int i = 0; i < 4; i++) {
                         if (colors[i] != color) rest.push_back(neighours[i]);
                     }
                     colorBoard->colorSame({ hook }, rest);
-                    toRemove.push_back(hook);
+                    kept--;
                     continue;
                 }
 
                 if (revColorsCount == num) {
-                    vector<Index> rest;
+                    Neighbours rest;
                     for (int i = 0; i < 4; i++) {
                         if (-colors[i] != color) rest.push_back(neighours[i]);
                     }
                     rest.push_back(hook);
                     colorBoard->colorSame(rest);
-                    toRemove.push_back(hook);
+                    kept--;
                     continue;
                 }
             }
@@ -373,7 +384,7 @@ void Algorithm::stepCountNeighbours()
             }
         }
         if (colorDouble != 0) {
-            vector<Index> restIndexes;
+            Neighbours restIndexes;
             for (int i = 0; i < 4; i++) {
                 if (colors[i] != colorDouble) restIndexes.push_back(neighours[i]);
             }
@@ -405,7 +416,7 @@ void Algorithm::stepCountNeighbours()
             }
         }
         if (colorDouble != 0) {
-            vector<Index> restIndexes;
+            Neighbours restIndexes;
             for (int i = 0; i < 4; i++) {
                 if (colors[i] != colorDouble && colors[i] != -colorDouble) restIndexes.push_back(neighours[i]);
             }
@@ -418,37 +429,33 @@ void Algorithm::stepCountNeighbours()
                 if (restIndexes.size() == 2) colorBoard->colorSame({ restIndexes[0] }, { restIndexes[1] });
                 break;
             case 3:
-                colorBoard->colorSame({ hook }, { restIndexes });
+                colorBoard->colorSame({ hook }, restIndexes);
                 break;
             }
             continue;
         }
     }
-
-    // Remove indexes
-    for (const Index& idx : toRemove) {
-        updateNumbers.erase(find(updateNumbers.begin(), updateNumbers.end(), idx));
-    }
+    updateNumbers.resize(kept);
 }
 
 void Algorithm::stepCheckCrosses()
 {
     int w = colorBoard->getWidth();
     int h = colorBoard->getHeight();
-    IndexTransform t(2, 2);
     for (int rotation = 0; rotation < 4; rotation++) {
-        t.rotation = rotation;
+        const Index* window = crosses->indexesOf(rotation);
+        const int* offsets = crosses->offsetsOf(rotation);
         for (int x = 0; x < w - 1; x++) {
+            cancellation.check();
             for (int y = 0; y < h - 1; y++) {
+                const int* field = &colorBoard->at(x, y);
+                int lt = colorBoard->colorOf(field[offsets[0]]);
+                int lb = colorBoard->colorOf(field[offsets[1]]);
+                int rt = colorBoard->colorOf(field[offsets[2]]);
+                int rb = colorBoard->colorOf(field[offsets[3]]);
                 Index hook(x, y);
-                Index i_lt = Index(0, 0) * t + hook;
-                Index i_lb = Index(0, 1) * t + hook;
-                Index i_rt = Index(1, 0) * t + hook;
-                Index i_rb = Index(1, 1) * t + hook;
-                int lt = (*colorBoard)[i_lt];
-                int rt = (*colorBoard)[i_rt];
-                int lb = (*colorBoard)[i_lb];
-                int rb = (*colorBoard)[i_rb];
+                Index i_lt = window[0] + hook;
+                Index i_lb = window[1] + hook;
                 
                 // cross with the same color
                 if (lb == -rb && rb == -rt && lt != lb && rb != 0) {
@@ -466,13 +473,15 @@ void Algorithm::stepCheckCrosses()
 
 void Algorithm::stepExpandAreas()
 {
-    BFSAreaVerifier bfs(*colorBoard);
+    cancellation.checkNow();
+    BFSAreaVerifier bfs(*colorBoard, &cancellation);
 
     vector<BFSAreaResult> areas = bfs.findAll();
 
     int endAreasCount = 0;
 
     for (auto& area : areas) {
+        cancellation.check();
         if (area.color == -1) endAreasCount++;
         if (!area.connectOutside) {
             if (area.connections.size() == 1) colorBoard->colorSame({ *area.connections.begin(), *area.area.begin() });
@@ -578,7 +587,8 @@ ostream& algorithms::slitherlink::operator<<(ostream& os, const Algorithm& a)
 
 // BFSAreaVerifier
 
-BFSAreaVerifier::BFSAreaVerifier(const ColorBoard& colors) : visited(colors.getWidth(), colors.getHeight()), colors(colors) { }
+BFSAreaVerifier::BFSAreaVerifier(const ColorBoard& colors, CancellationToken* cancellation)
+    : visited(colors.getWidth(), colors.getHeight()), colors(colors), cancellation(cancellation) { }
 
 BFSAreaResult BFSAreaVerifier::bfs(Index start)
 {
@@ -602,14 +612,15 @@ BFSAreaResult BFSAreaVerifier::bfs(Index start)
             if (colors[i] != -c) result.connections.insert(i);
             continue;
         }
-        if (visited[i]) {
+        if (visited.get(i)) {
             continue;
         }
+        if (cancellation) cancellation->check();
         result.area.insert(i);
-        for (Index& idx : i.neighbours(true, false)) {
+        for (const Index& idx : i.neighbours(true, false)) {
             q.push(idx);
         }
-        visited[i] = true;
+        visited.set(i);
     }
 
     return result;
@@ -621,13 +632,12 @@ vector<BFSAreaResult> BFSAreaVerifier::findAll()
     int w = colors.getWidth();
     int h = colors.getHeight();
 
-    for (int x = 0; x < w; x++)
-        for (int y = 0; y < h; y++)
-            visited[x][y] = false;
+    visited.fill(false);
 
-    for (int x = 0; x < w; x++) {
-        for (int y = 0; y < h; y++) {
-            if (!visited[x][y] && colors[x][y] != 0) results.push_back(bfs(Index(x, y)));
+    for (int y = 0; y < h; y++) {
+        const int* colorsRow = colors.row(y);
+        for (int x = 0; x < w; x++) {
+            if (!visited.get(x, y) && colorsRow[x] != 0) results.push_back(bfs(Index(x, y)));
         }
     }
 
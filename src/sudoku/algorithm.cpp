@@ -2,21 +2,90 @@
 
 #include <iostream>
 #include <string>
-#include <stack>
+#include <bit>
 
 using namespace algorithms::sudoku;
 using namespace std;
 
-Algorithm::Algorithm() { }
-Algorithm::~Algorithm() { }
+int algorithms::sudoku::parseDigit(char c, int size) {
+	int value = -1;
+	if (c >= '1' && c <= '9') value = c - '1';
+	else if (c >= 'A' && c <= 'Z') value = c - 'A' + 9;
+	else if (c >= 'a' && c <= 'z') value = c - 'a' + 9;
+	return value < size ? value : -1;
+}
+
+char algorithms::sudoku::digitChar(int value) {
+	return value < 9 ? (char)('1' + value) : (char)('A' + value - 9);
+}
+
+template <int N>
+BasicAlgorithm<N>::BasicAlgorithm() : emptyCount(0), solved(false), conflict(false), engine(Engine::BACKTRACKING) {
+	memory.reserve(fieldCount);
+
+	for (int k = 0; k < size; k++) {
+		for (int j = 0; j < size; j++) {
+			units[k][j] = k * size + j;
+			units[size + k][j] = j * size + k;
+			units[2 * size + k][j] = (k / N * N + j / N) * size + k % N * N + j % N;
+		}
+	}
 
-string Algorithm::getName() {
-	return "sudoku";
+	counters.add("placements", placements);
+	counters.add("backtracks", backtracks);
+	counters.add("guesses", guesses);
+	counters.add("propagated", propagated);
+	counters.add("dlxNodes", dlxNodes);
+	counters.add("bandGuesses", bands.getGuessCounter());
 }
+template <int N>
+BasicAlgorithm<N>::~BasicAlgorithm() { }
 
-void Algorithm::printFormat(ostream& o) {
-	o << "Sudoku file format\n";
-	o << "9 lines with 9 characters: 0-9 and space or '-' for empty\n";
+template <int N>
+shared_ptr<PuzzleAlgorithm> BasicAlgorithm<N>::clone() const {
+	shared_ptr<BasicAlgorithm> result = make_shared<BasicAlgorithm>();
+	result->engine = engine;
+	if (engine == Engine::DLX) result->buildExactCover();
+	return result;
+}
+
+template <int N>
+string BasicAlgorithm<N>::getName() {
+	// The classic sudoku keeps its name, the other sizes are named by the number of digits
+	return N == 3 ? "sudoku" : "sudoku" + to_string(size);
+}
+
+template <int N>
+int BasicAlgorithm<N>::getVersion() {
+	// Engines can find different solutions of puzzles with many solutions, so each has its own numbers.
+	// Backtracking is at version 3 since it propagates singles between the branches
+	if (engine == Engine::BITBOARD) return 2001;
+	return engine == Engine::DLX ? 1001 : 3;
+}
+
+template <int N>
+bool BasicAlgorithm<N>::setEngine(const string& name) {
+	if (name == "backtracking") engine = Engine::BACKTRACKING;
+	else if (name == "dlx") {
+		engine = Engine::DLX;
+		buildExactCover();
+	}
+	else if (name == "bitboard" && N == 3) engine = Engine::BITBOARD;
+	else return false;
+	return true;
+}
+
+template <int N>
+void BasicAlgorithm<N>::printFormat(ostream& o) {
+	o << "Sudoku " << size << "x" << size << " file format\n";
+	o << size << " lines with " << size << " characters: ";
+	if (size <= 9) o << "1-" << size;
+	else o << "1-9, A-" << digitChar(size - 1) << " (case insensitive)";
+	o << " and space, '-', '.' or '0' for empty\n";
+	o << "or the same " << fieldCount << " characters in a single line\n";
+	o << "In batch mode puzzles are separated by empty lines, single line puzzles can follow each other directly\n";
+	o << "Engines: backtracking (default), dlx" << (N == 3 ? ", bitboard" : "") << "\n";
+	if (N != 3) return;
 	o << "Example:\n\n";
 	o << string() +
 		"   6   75\n" +
@@ -30,10 +99,21 @@ void Algorithm::printFormat(ostream& o) {
 		"       6 \n\n";
 }
 
-void Algorithm::processFile(ifstream& inFile, ofstream& outFile) {
-	prepare(inFile);
-	
-	if (mainLoop()) {
+template <int N>
+void BasicAlgorithm<N>::parse(string_view input) {
+	prepare(input);
+}
+
+template <int N>
+void BasicAlgorithm<N>::solve() {
+	if (conflict) solved = false;
+	else if (engine == Engine::BITBOARD) solved = solveBands();
+	else solved = engine == Engine::DLX ? solveExactCover() : mainLoop();
+}
+
+template <int N>
+void BasicAlgorithm<N>::format(ostream& outFile) {
+	if (solved) {
 		outFile << *this;
 	}
 	else {
@@ -41,140 +121,330 @@ void Algorithm::processFile(ifstream& inFile, ofstream& outFile) {
 	}
 }
 
-void Algorithm::cleanUp() { }
+template <int N>
+bool BasicAlgorithm<N>::isSolved() {
+	return solved;
+}
+
+template <int N>
+void BasicAlgorithm<N>::cleanUp() { }
+
+template <int N>
+bool BasicAlgorithm<N>::nextPuzzle(TextReader& in, string_view& puzzle)
+{
+	string_view line;
+	bool any = false;
+	in.startGroup();
+	while (in.readLine(line)) {
+		if (line.empty()) {
+			if (any) break;
+			continue;
+		}
+		in.addToGroup(line);
+		// Whole puzzle in one line
+		if (!any && line.size() == (size_t)fieldCount) {
+			any = true;
+			break;
+		}
+		any = true;
+	}
+	puzzle = in.getGroup();
+	return any;
+}
 
-void Algorithm::prepare(ifstream& inFile)
+template <int N>
+void BasicAlgorithm<N>::prepare(string_view input)
 {
-	for (int i = 0; i < 9; i++) {
-		rows[i] = 0x1ff;
-		cols[i] = 0x1ff;
-		area[i % 3][i / 3] = 0x1ff;
+	for (int i = 0; i < size; i++) {
+		rows[i] = fullMask;
+		cols[i] = fullMask;
+		area.at(i % N, i / N) = fullMask;
 	}
+	conflict = false;
 
-	string line;
+	TextReader lines(input);
+	string_view line;
 	int y = 0;
-	int v, mask;
 
-	while (std::getline(inFile, line)) {
+	while (lines.readLine(line)) {
 		if (line.empty()) continue;
-		if (line.size() != 9) continue;
-
-		for (int x = 0; x < 9; x++) {
-			if (line[x] == ' ' || line[x] == '-') {
-				tab[x][y] = -1;
-				taken[x][y] = false;
-			}
-			else {
-				v = line[x] - '0' - 1;
-				mask = 0x1ff - (1 << v);
-				tab[x][y] = v;
-				taken[x][y] = true;
-				cols[x] &= mask;
-				rows[y] &= mask;
-				area[x / 3][y / 3] &= mask;
-			}
+		if (line.size() == (size_t)fieldCount && y == 0) {
+			for (; y < size; y++) parseRow(line.data() + y * size, y);
+			continue;
 		}
+		if (line.size() != (size_t)size) continue;
+		if (y >= size) throw WrongFileFormatException();
 
+		parseRow(line.data(), y);
 		y++;
 	}
 
-	if (y != 9) {
+	if (y != size) {
 		throw WrongFileFormatException();
 	}
+
+	hash.set(0);
+	tab.forEach([this](Index idx, int value) { hash.toggle(tab.offset(idx), value + 1); });
+}
+
+template <int N>
+void BasicAlgorithm<N>::parseRow(const char* row, int y)
+{
+	int v;
+	Mask mask;
+	for (int x = 0; x < size; x++) {
+		if (row[x] == ' ' || row[x] == '-' || row[x] == '.' || row[x] == '0') {
+			tab.at(x, y) = -1;
+			taken.at(x, y) = false;
+		}
+		else if ((v = parseDigit(row[x], size)) >= 0) {
+			mask = fullMask - (Mask)(1u << v);
+			if ((cols[x] & rows[y] & area.at(x / N, y / N) & ~mask) == 0) conflict = true;
+			tab.at(x, y) = v;
+			taken.at(x, y) = true;
+			cols[x] &= mask;
+			rows[y] &= mask;
+			area.at(x / N, y / N) &= mask;
+		}
+		else {
+			throw WrongFileFormatException();
+		}
+	}
 }
 
-inline void Algorithm::nextFreeField(int& i) const {
-	do i++;
-	while (i < 81 && taken[i % 9][i / 9]);
+template <int N>
+inline void BasicAlgorithm<N>::enterNext(Memory<Mask>& m) {
+	int l = countr_zero(m.mask);
+	m.mask &= m.mask - 1;
+	int x = m.field % size;
+	int y = m.field / size;
+	Mask r_mask = fullMask - (Mask)(1u << l);
+	setField(x, y, l);
+	cols[x] &= r_mask;
+	rows[y] &= r_mask;
+	area.at(x / N, y / N) &= r_mask;
+	++placements;
 }
 
-inline void Algorithm::backToPreviousField(int& i) const {
-	do i--;
-	while (i >= 0 && taken[i % 9][i / 9]);
+template <int N>
+inline void BasicAlgorithm<N>::clearField(int i) {
+	int x = i % size;
+	int y = i / size;
+	Mask bit = (Mask)(1u << tab.at(x, y));
+	cols[x] |= bit;
+	rows[y] |= bit;
+	area.at(x / N, y / N) |= bit;
+	setField(x, y, -1);
 }
 
-bool Algorithm::mainLoop() {
-	int l, r_mask;
-	
-	int i = 0;
-	while (taken[i % 9][i / 9]) i++;
-	
-	stack<Memory> s;
+template <int N>
+inline Memory<typename BasicAlgorithm<N>::Mask>& BasicAlgorithm<N>::pushField(int j, Mask mask) {
+	int depth = (int)memory.size();
+	int field = fields[j];
+	fields[j] = fields[depth];
+	fieldPosition[fields[j]] = j;
+	fields[depth] = field;
+	fieldPosition[field] = depth;
+	memory.push_back(Memory<Mask>{ field, mask });
+	return memory.back();
+}
 
-	// Index i loop through all fields. If index end in 81 that mean puzzle is solved. If end in 0 that mean no solution found
-	while (i < 81 && i >= 0) {
-		int x = i % 9;
-		int y = i / 9;
+template <int N>
+bool BasicAlgorithm<N>::propagate() {
+	// Possible digits of the fields, 0 for filled ones. Exact after a pass of naked singles which entered nothing
+	Mask masks[fieldCount] = {};
+	bool changed = true;
+	while (changed) {
+		changed = false;
 
-		// If field value is -1 index come here from previous field. Otherwise index returned from next field because it could not find a solution.
-		if (tab[x][y] == -1) {
-			
-			// Remember masks before any modifications
-			Memory m;
-			m.row = rows[y];
-			m.col = cols[x];
-			m.area = area[x / 3][y / 3];
-			m.mask = m.row & m.col & m.area;
+		// Naked singles. A field moved to position j by pushField was already checked in this pass
+		for (int j = (int)memory.size(); j < emptyCount; j++) {
+			// pushField moves another field to position j, so the entered one is saved first
+			int field = fields[j];
+			Mask mask = candidates(field);
+			if (mask == 0) return false;
+			if ((mask & (mask - 1)) == 0) {
+				enterNext(pushField(j, mask));
+				++propagated;
+				changed = true;
+				mask = 0;
+			}
+			masks[field] = mask;
+		}
+		// Hidden singles are looked for only when there are no naked ones, since checking the units costs more
+		if (changed) continue;
 
-			// Mask eq 0 mean that no number can be entered - back to previous field
-			if (m.mask == 0) {
-				backToPreviousField(i);
-				continue;
+		// Hidden singles. Digits possible in exactly one field of the unit are those in once but not in twice.
+		// Digits entered here leave the masks of their peers too wide, which can only hide a single until the next pass
+		for (int u = 0; u < unitCount; u++) {
+			Mask once = 0, twice = 0;
+			for (int i : units[u]) {
+				twice |= once & masks[i];
+				once |= masks[i];
 			}
+			// Digits not yet entered in the unit
+			Mask missing = u < size ? rows[u] : u < 2 * size ? cols[u - size] : area.at((u - 2 * size) % N, (u - 2 * size) / N);
+			if ((missing & ~once) != 0) return false;
 
-			// Find first possible digit to enter
-			l = 0;
-			while (!((1 << l) & m.mask)) l++;
-			
-			// Update table and masks
-			tab[x][y] = l;
-			r_mask = 0x1ff - (1 << l);
-			cols[x] &= r_mask;
-			rows[y] &= r_mask;
-			area[x / 3][y / 3] &= r_mask;
+			Mask hidden = once & ~twice & missing;
+			if (hidden == 0) continue;
+			for (int i : units[u]) {
+				Mask bit = masks[i] & hidden;
+				if (bit == 0) continue;
+				// Two digits possible only in the same field
+				if ((bit & (bit - 1)) != 0) return false;
+				if ((candidates(i) & bit) == 0) continue;
+				enterNext(pushField(fieldPosition[i], bit));
+				++propagated;
+				changed = true;
+				masks[i] = 0;
+			}
+		}
+	}
+	return true;
+}
 
-			s.push(m);
-			nextFreeField(i);
+template <int N>
+void BasicAlgorithm<N>::collectEmptyFields() {
+	emptyCount = 0;
+	for (int i = 0; i < fieldCount; i++) {
+		if (!taken.at(i % size, i / size)) {
+			fieldPosition[i] = emptyCount;
+			fields[emptyCount++] = i;
 		}
-		else {
-			Memory m = s.top();
-
-			// Find next possible digit to enter
-			l = tab[x][y] + 1;
-			while (l < 9 && !((1 << l) & m.mask)) l++;
-
-			if (l >= 9) {
-				// No possible digit - back to previous field
-				// Remind the masks
-				cols[x] = m.col;
-				rows[y] = m.row;
-				area[x / 3][y / 3] = m.area;
-
-				tab[x][y] = -1;
-				s.pop();
-				backToPreviousField(i);
-				continue;
+	}
+	memory.clear();
+}
+
+template <int N>
+bool BasicAlgorithm<N>::mainLoop() {
+	collectEmptyFields();
+
+	// Singles are entered before the first branch and after every digit tried in a branch
+	bool consistent = propagate();
+	while (true) {
+		cancellation.check();
+		if (consistent) {
+			int depth = (int)memory.size();
+			if (depth == emptyCount) return true;
+
+			// Branch on the empty field with the fewest possible digits. After propagation every field has at least two
+			int best = depth;
+			Mask bestMask = 0;
+			int bestCount = size + 1;
+			for (int j = depth; j < emptyCount; j++) {
+				Mask mask = candidates(fields[j]);
+				int n = popcount(mask);
+				if (n < bestCount) {
+					best = j;
+					bestMask = mask;
+					bestCount = n;
+					if (n <= 2) break;
+				}
+			}
+
+			enterNext(pushField(best, bestMask));
+			++guesses;
+			consistent = propagate();
+			continue;
+		}
+
+		// Go back to the last branch with another digit to try. Digits entered by propagation have no other digits
+		++backtracks;
+		while (true) {
+			if (memory.empty()) return false;
+			Memory<Mask>& m = memory.back();
+			clearField(m.field);
+			if (m.mask != 0) {
+				enterNext(m);
+				break;
 			}
+			memory.pop_back();
+		}
+		consistent = propagate();
+	}
+}
 
-			tab[x][y] = l;
-			r_mask = 0x1ff - (1 << l);
-			cols[x] = m.col & r_mask;
-			rows[y] = m.row & r_mask;
-			area[x / 3][y / 3] = m.area & r_mask;
-			nextFreeField(i);
+template <int N>
+void BasicAlgorithm<N>::buildExactCover() {
+	if (dlx) return;
+	dlx = make_unique<DancingLinks>(4 * fieldCount);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			for (int v = 0; v < size; v++) {
+				int columns[4] = { y * size + x, fieldCount + y * size + v, 2 * fieldCount + x * size + v,
+					3 * fieldCount + (y / N * N + x / N) * size + v };
+				dlx->addRow(columns, 4);
+			}
 		}
 	}
+}
 
-	return i >= 81;
+template <int N>
+bool BasicAlgorithm<N>::solveExactCover() {
+	buildExactCover();
+	// Rows of the clues are selected, a clue conflicting with another one means there is no solution
+	dlx->reset();
+	bool result = true;
+	for (int i = 0; i < fieldCount && result; i++) {
+		if (taken.at(i % size, i / size)) result = dlx->selectRow(i * size + tab.at(i % size, i / size));
+	}
+	// The matrix is built after the counters are registered, so its nodes are added to dlxNodes, also for a timeout
+	Counter& nodes = dlx->getNodeCounter();
+	nodes.reset();
+	try {
+		if (result) result = dlx->search(&cancellation);
+	}
+	catch (...) {
+		dlxNodes.add(nodes.get());
+		throw;
+	}
+	dlxNodes.add(nodes.get());
+	if (result) {
+		for (int row : dlx->getSolution()) {
+			int i = row / size;
+			if (!taken.at(i % size, i / size)) setField(i % size, i / size, row % size);
+		}
+	}
+	dlx->reset();
+	return result;
 }
 
-ostream& algorithms::sudoku::operator<<(ostream& o, const Algorithm& a)
+template <int N>
+bool BasicAlgorithm<N>::solveBands() {
+	// The band solver holds 9x9 boards only, the other sizes must not instantiate the call
+	if constexpr (N != 3) {
+		return false;
+	}
+	else {
+		int cells[fieldCount];
+		for (int i = 0; i < fieldCount; i++) cells[i] = tab.at(i % size, i / size);
+		if (!bands.solve(cells, &cancellation)) return false;
+		for (int i = 0; i < fieldCount; i++) {
+			if (!taken.at(i % size, i / size)) setField(i % size, i / size, cells[i]);
+		}
+		return true;
+	}
+}
+
+template <int N>
+ostream& algorithms::sudoku::operator<<(ostream& o, const BasicAlgorithm<N>& a)
 {
-	for (int y = 0; y < 9; y++) {
-		for (int x = 0; x < 9; x++) {
-			o << a.tab[x][y] + 1;
+	for (int y = 0; y < a.size; y++) {
+		for (int x = 0; x < a.size; x++) {
+			o << digitChar(a.tab.at(x, y));
 		}
 		o << endl;
 	}
 	return o;
-}
\ No newline at end of file
+}
+
+template class algorithms::sudoku::BasicAlgorithm<2>;
+template class algorithms::sudoku::BasicAlgorithm<3>;
+template class algorithms::sudoku::BasicAlgorithm<4>;
+template class algorithms::sudoku::BasicAlgorithm<5>;
+
+template ostream& algorithms::sudoku::operator<<(ostream&, const BasicAlgorithm<2>&);
+template ostream& algorithms::sudoku::operator<<(ostream&, const BasicAlgorithm<3>&);
+template ostream& algorithms::sudoku::operator<<(ostream&, const BasicAlgorithm<4>&);
+template ostream& algorithms::sudoku::operator<<(ostream&, const BasicAlgorithm<5>&);
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include <sudoku.h>
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace algorithms::sudoku;
+using namespace std;
+
+namespace {
+
+	/**
+	* Set of the 81 fields of a 9x9 sudoku. Band b (rows 3b to 3b + 2) is kept in the 32-bit lane b,
+	* field (x, y) is bit (y % 3) * 9 + x of its lane. Lane 3 is always 0.
+	* All shifts work inside the lanes, so the three bands are processed at once.
+	*/
+	struct Bands {
+#if defined(__SSE2__)
+		__m128i v;
+
+		static inline Bands of(uint32_t b0, uint32_t b1, uint32_t b2) { return { _mm_setr_epi32((int)b0, (int)b1, (int)b2, 0) }; }
+		static inline Bands zero() { return { _mm_setzero_si128() }; }
+
+		inline Bands operator&(Bands o) const { return { _mm_and_si128(v, o.v) }; }
+		inline Bands operator|(Bands o) const { return { _mm_or_si128(v, o.v) }; }
+		inline Bands operator^(Bands o) const { return { _mm_xor_si128(v, o.v) }; }
+		inline Bands operator-(Bands o) const { return { _mm_sub_epi32(v, o.v) }; }
+		inline Bands operator<<(int n) const { return { _mm_slli_epi32(v, n) }; }
+		inline Bands operator>>(int n) const { return { _mm_srli_epi32(v, n) }; }
+		/**
+		* Returns this & ~o
+		*/
+		inline Bands andNot(Bands o) const { return { _mm_andnot_si128(o.v, v) }; }
+		/**
+		* Lanes (1, 2, 0) and (2, 0, 1): the other two bands of each band
+		*/
+		inline Bands next() const { return { _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 0, 2, 1)) }; }
+		inline Bands previous() const { return { _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 0, 2)) }; }
+		inline bool none() const
+		{
+#if defined(__SSE4_1__)
+			return _mm_testz_si128(v, v);
+#else
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xffff;
+#endif
+		}
+		inline void lanes(uint32_t* out) const { _mm_storeu_si128((__m128i*)out, v); }
+#else
+		uint32_t l[4];
+
+		static inline Bands of(uint32_t b0, uint32_t b1, uint32_t b2) { return { { b0, b1, b2, 0 } }; }
+		static inline Bands zero() { return { { 0, 0, 0, 0 } }; }
+
+		template <typename F>
+		inline Bands map(Bands o, F f) const { return { { f(l[0], o.l[0]), f(l[1], o.l[1]), f(l[2], o.l[2]), f(l[3], o.l[3]) } }; }
+		inline Bands operator&(Bands o) const { return map(o, [](uint32_t a, uint32_t b) { return a & b; }); }
+		inline Bands operator|(Bands o) const { return map(o, [](uint32_t a, uint32_t b) { return a | b; }); }
+		inline Bands operator^(Bands o) const { return map(o, [](uint32_t a, uint32_t b) { return a ^ b; }); }
+		inline Bands operator-(Bands o) const { return map(o, [](uint32_t a, uint32_t b) { return a - b; }); }
+		inline Bands operator<<(int n) const { return { { l[0] << n, l[1] << n, l[2] << n, l[3] << n } }; }
+		inline Bands operator>>(int n) const { return { { l[0] >> n, l[1] >> n, l[2] >> n, l[3] >> n } }; }
+		inline Bands andNot(Bands o) const { return map(o, [](uint32_t a, uint32_t b) { return a & ~b; }); }
+		inline Bands next() const { return { { l[1], l[2], l[0], l[3] } }; }
+		inline Bands previous() const { return { { l[2], l[0], l[1], l[3] } }; }
+		inline bool none() const { return (l[0] | l[1] | l[2] | l[3]) == 0; }
+		inline void lanes(uint32_t* out) const { for (int i = 0; i < 4; i++) out[i] = l[i]; }
+#endif
+
+		static inline Bands all(uint32_t lane) { return of(lane, lane, lane); }
+	};
+
+	/**
+	* Calls func(i) for every field in the set, in increasing order
+	*/
+	template <typename F>
+	inline void forEachField(Bands set, F func)
+	{
+		uint32_t b[4];
+		set.lanes(b);
+		for (int lane = 0; lane < 3; lane++) {
+			for (uint32_t bits = b[lane]; bits != 0; bits &= bits - 1) func(lane * 27 + countr_zero(bits));
+		}
+	}
+
+	// The first bit of each triple (three fields of one row in one area), of each row and of each area of the top row
+	const uint32_t tripleStarts = 0x1249249;
+	const uint32_t rowStarts = 0x40201;
+	const uint32_t areaStarts = 0x49;
+	const uint32_t rowBits = 0x1ff;
+
+	// Every row, area and column of a band has a bit in these masks
+	const Bands everyRow = Bands::all(rowStarts);
+	const Bands everyArea = Bands::all(areaStarts);
+	const Bands everyColumn = Bands::all(rowBits);
+
+	/**
+	* Fills the 3 fields of the triples whose first bit is set
+	*/
+	inline Bands fillTriples(Bands t) { return (t << 3) - t; }
+	/**
+	* Fills the 9 fields of the rows whose first bit is set
+	*/
+	inline Bands fillRows(Bands r) { return (r << 9) - r; }
+	/**
+	* Copies the top row of the band to the other two rows
+	*/
+	inline Bands copyDown(Bands r) { return r | (r << 9) | (r << 18); }
+	/**
+	* Bits set in at least two of the three sets
+	*/
+	inline Bands twoOf(Bands a, Bands b, Bands c) { return (a & b) | (c & (a | b)); }
+
+	/**
+	* Set of each single field, and the fields seen from each field (its row, column and area) without the field itself
+	*/
+	struct FieldTable {
+		Bands field[81];
+		Bands peers[81];
+
+		FieldTable()
+		{
+			for (int i = 0; i < 81; i++) {
+				uint32_t f[3] = { 0, 0, 0 };
+				uint32_t p[3] = { 0, 0, 0 };
+				f[i / 27] = 1u << (i % 27);
+				for (int j = 0; j < 81; j++) {
+					bool peer = j / 9 == i / 9 || j % 9 == i % 9 || (j / 27 == i / 27 && j % 9 / 3 == i % 9 / 3);
+					if (peer && j != i) p[j / 27] |= 1u << (j % 27);
+				}
+				field[i] = Bands::of(f[0], f[1], f[2]);
+				peers[i] = Bands::of(p[0], p[1], p[2]);
+			}
+		}
+	};
+
+	const FieldTable fieldTable;
+
+	inline bool contains(Bands set, int i) { return !(set & fieldTable.field[i]).none(); }
+
+	/**
+	* Fields sharing a row, a column or an area with some field of the set, including the set itself
+	*/
+	inline Bands seenFrom(Bands set)
+	{
+		Bands triples = (set | (set >> 1) | (set >> 2)) & Bands::all(tripleStarts);
+		Bands rows = (triples | (triples >> 3) | (triples >> 6)) & everyRow;
+		Bands areas = (triples | (triples >> 9) | (triples >> 18)) & everyArea;
+		Bands columns = (set | (set >> 9) | (set >> 18)) & everyColumn;
+		return fillRows(rows) | copyDown(fillTriples(areas) | columns | columns.next() | columns.previous());
+	}
+}
+
+/**
+* Possible fields of each digit. A filled field stays only in the set of its digit.
+*/
+struct BandSolver::State {
+	Bands digits[9];
+	Bands unsolved;
+
+	/**
+	* Enters the digit in the empty fields of the set and removes it from their peers.
+	* Two fields of the set seeing each other are not detected here: the unit is then left without some other digit,
+	* which propagate reports.
+	*/
+	inline void assign(int digit, Bands fields)
+	{
+		for (int d = 0; d < 9; d++) digits[d] = digits[d].andNot(fields);
+		digits[digit] = digits[digit].andNot(seenFrom(fields)) | fields;
+		unsolved = unsolved.andNot(fields);
+	}
+};
+
+bool BandSolver::solve(int* cells, CancellationToken* cancellation)
+{
+	State state;
+	for (int d = 0; d < 9; d++) state.digits[d] = Bands::all((1u << 27) - 1);
+	state.unsolved = Bands::all((1u << 27) - 1);
+
+	// Fields of each digit, empty fields are collected at index 0 and ignored
+	uint32_t clues[10][3] = {};
+	for (int i = 0; i < 81; i++) clues[cells[i] + 1][i / 27] |= 1u << (i % 27);
+	// Conflicting clues leave a unit without a digit, so the search finds no solution
+	for (int d = 0; d < 9; d++) state.assign(d, Bands::of(clues[d + 1][0], clues[d + 1][1], clues[d + 1][2]));
+	return search(state, cells, cancellation);
+}
+
+bool BandSolver::search(State& state, int* cells, CancellationToken* cancellation)
+{
+	while (true) {
+		if (cancellation) cancellation->check();
+		if (!propagate(state)) return false;
+
+		if (state.unsolved.none()) {
+			for (int d = 0; d < 9; d++) forEachField(state.digits[d], [cells, d](int i) { cells[i] = d; });
+			return true;
+		}
+
+		// Guess the lowest digit of a field with two digits if there is one, otherwise of a field with the fewest digits
+		Bands once = Bands::zero(), twice = Bands::zero(), thrice = Bands::zero();
+		for (int d = 0; d < 9; d++) {
+			thrice = thrice | (twice & state.digits[d]);
+			twice = twice | (once & state.digits[d]);
+			once = once | state.digits[d];
+		}
+		Bands pairs = (twice.andNot(thrice)) & state.unsolved;
+		int field = -1;
+		int best = 10;
+		forEachField(pairs.none() ? state.unsolved : pairs, [&](int i) {
+			if (best == 2) return;
+			int count = 0;
+			for (int d = 0; d < 9; d++) count += contains(state.digits[d], i);
+			if (count < best) {
+				best = count;
+				field = i;
+			}
+		});
+		int digit = 0;
+		while (!contains(state.digits[digit], field)) digit++;
+
+		++guesses;
+		State copy = state;
+		copy.assign(digit, fieldTable.field[field]);
+		if (search(copy, cells, cancellation)) return true;
+		// The digit is not in the field, continue with the remaining ones
+		state.digits[digit] = state.digits[digit].andNot(fieldTable.field[field]);
+	}
+}
+
+namespace {
+
+	/**
+	* Where a digit is possible in each unit. Triples are three fields of one row in one area,
+	* summaries of a triple, row or area are kept in its first bit, summaries of a column in the top row of the band.
+	*/
+	struct Units {
+		Bands tripleAny;
+		Bands tripleMany;
+		Bands rowAny;
+		Bands rowOneTriple;
+		Bands rowOne;
+		Bands areaAny;
+		Bands areaOneTriple;
+		Bands areaOne;
+		// Columns within the band and across the bands
+		Bands bandColumn;
+		Bands columnAny;
+		Bands columnOneBand;
+		Bands columnOne;
+
+		Units(Bands x)
+		{
+			Bands t0 = x & Bands::all(tripleStarts);
+			Bands t1 = (x >> 1) & Bands::all(tripleStarts);
+			Bands t2 = (x >> 2) & Bands::all(tripleStarts);
+			tripleAny = t0 | t1 | t2;
+			tripleMany = twoOf(t0, t1, t2);
+
+			Bands r0 = tripleAny & everyRow;
+			Bands r1 = (tripleAny >> 3) & everyRow;
+			Bands r2 = (tripleAny >> 6) & everyRow;
+			rowAny = r0 | r1 | r2;
+			rowOneTriple = rowAny.andNot(twoOf(r0, r1, r2));
+			rowOne = rowOneTriple.andNot((tripleMany | (tripleMany >> 3) | (tripleMany >> 6)) & everyRow);
+
+			Bands a0 = tripleAny & everyArea;
+			Bands a1 = (tripleAny >> 9) & everyArea;
+			Bands a2 = (tripleAny >> 18) & everyArea;
+			areaAny = a0 | a1 | a2;
+			areaOneTriple = areaAny.andNot(twoOf(a0, a1, a2));
+			areaOne = areaOneTriple.andNot((tripleMany | (tripleMany >> 9) | (tripleMany >> 18)) & everyArea);
+
+			Bands c0 = x & everyColumn;
+			Bands c1 = (x >> 9) & everyColumn;
+			Bands c2 = (x >> 18) & everyColumn;
+			bandColumn = c0 | c1 | c2;
+			Bands bandColumnMany = twoOf(c0, c1, c2);
+			columnAny = bandColumn | bandColumn.next() | bandColumn.previous();
+			columnOneBand = columnAny.andNot(twoOf(bandColumn, bandColumn.next(), bandColumn.previous()));
+			columnOne = columnOneBand.andNot(bandColumnMany | bandColumnMany.next() | bandColumnMany.previous());
+		}
+
+		/**
+		* Checks that every row, area and column has a field for the digit
+		*/
+		inline bool complete() const { return ((rowAny ^ everyRow) | (areaAny ^ everyArea) | (columnAny ^ everyColumn)).none(); }
+		/**
+		* Fields which are the only place for the digit in their row, area or column
+		*/
+		inline Bands hidden(Bands x) const { return x & (fillRows(rowOne) | copyDown(fillTriples(areaOne)) | copyDown(columnOne)); }
+		/**
+		* Fields where the digit is excluded by box-line reductions. A row in one area (claiming) removes the digit
+		* from the rest of the area, an area in one row (pointing) removes it from the rest of the row. The same for columns.
+		*/
+		Bands lineReductions() const
+		{
+			Bands claiming = tripleAny & (rowOneTriple | (rowOneTriple << 3) | (rowOneTriple << 6));
+			Bands claimed = copyDown((claiming | (claiming >> 9) | (claiming >> 18)) & everyArea).andNot(claiming);
+			Bands pointing = tripleAny & copyDown(areaOneTriple);
+			Bands pointingRows = (pointing | (pointing >> 3) | (pointing >> 6)) & everyRow;
+			Bands pointed = (pointingRows | (pointingRows << 3) | (pointingRows << 6)).andNot(pointing);
+
+			Bands columnClaiming = bandColumn & columnOneBand;
+			Bands columnClaimed = fillTriples((columnClaiming | (columnClaiming >> 1) | (columnClaiming >> 2)) & everyArea).andNot(columnClaiming);
+			Bands i0 = bandColumn & everyArea;
+			Bands i1 = (bandColumn >> 1) & everyArea;
+			Bands i2 = (bandColumn >> 2) & everyArea;
+			Bands columnPointing = bandColumn & fillTriples((i0 | i1 | i2).andNot(twoOf(i0, i1, i2)));
+
+			return fillTriples(claimed | pointed) | copyDown(columnClaimed | columnPointing.next() | columnPointing.previous());
+		}
+	};
+}
+
+bool BandSolver::propagate(State& state)
+{
+	// Sets of the digits when they were last checked for hidden singles and for box-line reductions.
+	// A digit whose set did not change since then gives nothing new
+	Bands singlesChecked[9];
+	Bands linesChecked[9];
+	bool first = true;
+	bool firstLines = true;
+	while (true) {
+		// Naked singles: fields possible for exactly one digit
+		Bands once = Bands::zero(), twice = Bands::zero();
+		for (int d = 0; d < 9; d++) {
+			twice = twice | (once & state.digits[d]);
+			once = once | state.digits[d];
+		}
+		if (!state.unsolved.andNot(once).none()) return false;
+
+		Bands singles = once.andNot(twice) & state.unsolved;
+		if (!singles.none()) {
+			for (int d = 0; d < 9; d++) {
+				Bands fields = state.digits[d] & singles;
+				if (!fields.none()) state.assign(d, fields);
+			}
+			continue;
+		}
+
+		// Hidden singles
+		bool changed = false;
+		for (int d = 0; d < 9; d++) {
+			Bands x = state.digits[d];
+			if (!first && (x ^ singlesChecked[d]).none()) continue;
+			singlesChecked[d] = x;
+
+			Units units(x);
+			if (!units.complete()) return false;
+			Bands hidden = units.hidden(x) & state.unsolved;
+			if (!hidden.none()) {
+				state.assign(d, hidden);
+				changed = true;
+			}
+		}
+		first = false;
+		if (changed) continue;
+
+		// Box-line reductions, only when there are no singles
+		for (int d = 0; d < 9; d++) {
+			Bands x = state.digits[d];
+			if (!firstLines && (x ^ linesChecked[d]).none()) continue;
+			linesChecked[d] = x;
+
+			Bands removed = Units(x).lineReductions() & x;
+			if (!removed.none()) {
+				state.digits[d] = x.andNot(removed);
+				changed = true;
+			}
+		}
+		firstLines = false;
+		if (!changed) return true;
+	}
+}
@@ -0,0 +1,70 @@
+#include <base-lib.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "test.h"
+
+using namespace baselib;
+
+// Values with the highest bit set fall into the last buckets of the histogram
+static void testHistogramLargestValues()
+{
+	LatencyHistogram histogram;
+	histogram.record(UINT64_MAX);
+	histogram.record(std::uint64_t(1) << 63);
+	histogram.record(5);
+	CHECK(histogram.count() == 3);
+	CHECK(histogram.min() == 5);
+	CHECK(histogram.max() == UINT64_MAX);
+	CHECK(histogram.percentile(100) == UINT64_MAX);
+	CHECK(histogram.percentile(50) >= std::uint64_t(1) << 63);
+	CHECK(histogram.percentile(10) == 5);
+
+	LatencyHistogram merged;
+	merged.merge(histogram);
+	CHECK(merged.count() == 3);
+	CHECK(merged.percentile(100) == UINT64_MAX);
+}
+
+// An entry cut off by an interrupted write is removed when the cache is opened, the complete ones stay readable
+static void testCacheWithIncompleteEntry()
+{
+	namespace fs = std::filesystem;
+	std::string path = (fs::temp_directory_path() / "base_lib_test.cache").string();
+	fs::remove(path);
+	SolutionCache::Key first = SolutionCache::keyOf("test", 1, "first");
+	SolutionCache::Key second = SolutionCache::keyOf("test", 1, "second");
+	{
+		SolutionCache cache(path);
+		cache.store(first, "first result");
+	}
+	std::uintmax_t completeSize = fs::file_size(path);
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::app);
+		file << "incomplete entry";
+	}
+	{
+		SolutionCache cache(path);
+		CHECK(fs::file_size(path) == completeSize);
+		std::string_view result;
+		CHECK(cache.find(first, result) && result == "first result");
+		cache.store(second, "second result");
+	}
+	{
+		SolutionCache cache(path);
+		std::string_view result;
+		CHECK(cache.size() == 2);
+		CHECK(cache.find(first, result) && result == "first result");
+		CHECK(cache.find(second, result) && result == "second result");
+	}
+	fs::remove(path);
+}
+
+int main()
+{
+	testHistogramLargestValues();
+	testCacheWithIncompleteEntry();
+	return test::finish("base_lib_test");
+}
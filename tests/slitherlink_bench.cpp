@@ -0,0 +1,69 @@
+#include <slitherlink.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "test.h"
+
+/*
+Counts the heap allocations made by the slitherlink propagation loop (stepCountNeighbours and stepCheckCrosses)
+on a large board and measures the time of its passes. The loop must not allocate at all.
+*/
+
+static std::atomic<long> allocations(0);
+static std::atomic<bool> counting(false);
+
+void* operator new(std::size_t size)
+{
+	if (counting.load(std::memory_order_relaxed)) allocations++;
+	void* result = std::malloc(size == 0 ? 1 : size);
+	if (result == nullptr) throw std::bad_alloc();
+	return result;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+class Bench : public algorithms::slitherlink::Algorithm {
+public:
+	/**
+	* Runs the propagation loop until nothing changes.
+	* @return Number of passes.
+	*/
+	int propagate(std::string_view puzzle)
+	{
+		parse(puzzle);
+		findPatterns();
+		int passes = 0;
+		counting = true;
+		do {
+			colorBoard->updateFlag = false;
+			stepCountNeighbours();
+			stepCheckCrosses();
+			passes++;
+		} while (colorBoard->updateFlag);
+		counting = false;
+		cleanUp();
+		arena.reset();
+		return passes;
+	}
+};
+
+int main()
+{
+	std::string puzzle = test::combSlitherlink(300, 300);
+	Bench bench;
+	bench.propagate(puzzle);
+
+	allocations = 0;
+	auto start = std::chrono::steady_clock::now();
+	int passes = bench.propagate(puzzle);
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "300x300 board: " << passes << " passes in " << elapsed << " us, "
+		<< elapsed / passes << " us per pass, " << allocations << " allocations" << std::endl;
+	CHECK(passes > 1);
+	CHECK(allocations == 0);
+	return test::finish("slitherlink_bench");
+}
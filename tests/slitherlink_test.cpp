@@ -0,0 +1,99 @@
+#include <slitherlink.h>
+
+#include <chrono>
+#include <sstream>
+
+#include "test.h"
+
+using namespace algorithms::slitherlink;
+
+// The hash restored by undoTo matches the board after the rollback
+static void testHashAfterUndo()
+{
+	ColorBoard board(5, 5);
+	Trail<int> trail;
+	board.setTrail(&trail);
+
+	board.colorSame({ Index(1, 1), Index(1, 2) }, { Index(2, 1) });
+	uint64_t marked = board.getHash();
+	ColorBoard::Mark mark = board.mark();
+
+	board.colorSame({ Index(2, 1), Index(3, 3) }, { Index(1, 1), Index(0, 4) });
+	board.colorSame({ Index(4, 4) });
+	CHECK(board.getHash() != marked);
+	CHECK(board.getHash() == ZobristHash::ofBoard(board));
+
+	board.undoTo(mark);
+	CHECK(board.getHash() == marked);
+	CHECK(board.getHash() == ZobristHash::ofBoard(board));
+}
+
+// A board without a trail can be marked and rolled back, which leaves it unchanged
+static void testUndoWithoutTrail()
+{
+	ColorBoard board(3, 3);
+	ColorBoard::Mark mark = board.mark();
+	board.colorSame({ Index(0, 0), Index(1, 1) });
+	uint64_t colored = board.getHash();
+
+	board.undoTo(mark);
+	CHECK(board[Index(0, 0)] != 0);
+	CHECK(board.getHash() == colored);
+	CHECK(board.getHash() == ZobristHash::ofBoard(board));
+}
+
+class TimedAlgorithm : public Algorithm {
+public:
+	/**
+	* Parses and solves the puzzle with the time limit, then frees its state.
+	*/
+	void solveWithin(std::string_view puzzle, std::chrono::nanoseconds timeout)
+	{
+		cancellation.start(timeout);
+		try {
+			parse(puzzle);
+			solve();
+		}
+		catch (...) {
+			cleanUp();
+			arena.reset();
+			throw;
+		}
+		cleanUp();
+		arena.reset();
+	}
+};
+
+// A tiny time limit stops the solver on a large board long before it would finish
+static void testTimeoutOnLargeBoard()
+{
+	std::string puzzle = test::combSlitherlink(300, 300);
+	TimedAlgorithm algorithm;
+	std::ostringstream out;
+	auto start = std::chrono::steady_clock::now();
+	CHECK(algorithm.solvePuzzle(puzzle, out) == Outcome::SOLVED);
+	auto solveTime = std::chrono::steady_clock::now() - start;
+
+	bool timedOut = false;
+	start = std::chrono::steady_clock::now();
+	try {
+		algorithm.solveWithin(puzzle, std::chrono::microseconds(100));
+	}
+	catch (const TimeoutException&) {
+		timedOut = true;
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	CHECK(timedOut);
+	CHECK(elapsed < solveTime / 2);
+
+	algorithm.setTimeout(std::chrono::microseconds(100));
+	CHECK(algorithm.solvePuzzle(puzzle, out) == Outcome::TIMEOUT);
+}
+
+int main()
+{
+	testHashAfterUndo();
+	testUndoWithoutTrail();
+	testTimeoutOnLargeBoard();
+	return test::finish("slitherlink_test");
+}
@@ -0,0 +1,97 @@
+#include <sudoku.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "test.h"
+
+using namespace algorithms::sudoku;
+
+class PropagatingAlgorithm : public Algorithm {
+public:
+	/**
+	* Parses the puzzle and enters its singles.
+	* @return false if propagate found a contradiction.
+	*/
+	bool propagateOnce(std::string_view puzzle)
+	{
+		parse(puzzle);
+		collectEmptyFields();
+		return propagate();
+	}
+
+	/**
+	* Returns whether an empty field has one possible digit, or a digit missing in a unit has one possible field.
+	*/
+	bool hasSingle() const
+	{
+		for (int j = (int)memory.size(); j < emptyCount; j++) {
+			if (std::popcount(candidates(fields[j])) == 1) return true;
+		}
+		for (int u = 0; u < unitCount; u++) {
+			Mask missing = u < size ? rows[u] : u < 2 * size ? cols[u - size] : area.at((u - 2 * size) % 3, (u - 2 * size) / 3);
+			for (int digit = 0; digit < size; digit++) {
+				if ((missing & (1u << digit)) == 0) continue;
+				int count = 0;
+				for (int i : units[u]) {
+					if (tab.at(i % size, i / size) < 0 && (candidates(i) & (1u << digit)) != 0) count++;
+				}
+				if (count == 1) return true;
+			}
+		}
+		return false;
+	}
+};
+
+// Puzzles made by removing random fields of a solved grid have a solution, so propagate finds no contradiction
+// and stops only at the fixed point, with no naked or hidden single left
+static void testPropagateLeavesNoSingles()
+{
+	const std::string solution =
+		"134692875" "987543621" "652871943" "896754312" "743219586" "521386794" "479165238" "368427159" "215938467";
+	std::mt19937 random(2024);
+	PropagatingAlgorithm algorithm;
+	int withSingles = 0;
+	int contradictions = 0;
+	for (int n = 0; n < 3000; n++) {
+		// Relabeling the digits gives other grids with the same structure
+		std::string digits = "123456789";
+		std::shuffle(digits.begin(), digits.end(), random);
+		int clues = 20 + n % 20;
+		std::string puzzle(81, '.');
+		for (int i = 0; i < 81; i++) {
+			if ((int)(random() % 81) < clues) puzzle[i] = digits[solution[i] - '1'];
+		}
+		if (!algorithm.propagateOnce(puzzle)) contradictions++;
+		else if (algorithm.hasSingle()) withSingles++;
+	}
+	CHECK(contradictions == 0);
+	CHECK(withSingles == 0);
+}
+
+// Two equal clues in a column are rejected before the search. Without the check the backtracking engine searches
+// the nearly empty board for a long time, which the time limit turns into a failure
+static void testConflictingClues()
+{
+	std::string puzzle =
+		"1........" "........." "........." "1........" "........." "........." "........." "........." ".........";
+	for (std::string engine : { "backtracking", "dlx", "bitboard" }) {
+		Algorithm algorithm;
+		CHECK(algorithm.setEngine(engine));
+		algorithm.setTimeout(std::chrono::seconds(1));
+		std::ostringstream result;
+		CHECK(algorithm.solvePuzzle(puzzle, result) == Outcome::SOLVED);
+		CHECK(result.str() == "No solutions\n");
+	}
+}
+
+int main()
+{
+	testPropagateLeavesNoSingles();
+	testConflictingClues();
+	return test::finish("sudoku_test");
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <iostream>
+#include <string>
+
+/*
+Helpers shared by the test programs. Every test is a program that returns 0 when all its checks pass,
+they are built and run by "make test".
+*/
+
+namespace test {
+	inline int failures = 0;
+
+	inline void check(bool passed, const char* condition, const char* file, int line)
+	{
+		if (passed) return;
+		failures++;
+		std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+	}
+
+	/**
+	* Prints the result of the test program and returns its exit code.
+	*/
+	inline int finish(const char* name)
+	{
+		std::cout << name << ": " << (failures == 0 ? "passed" : "FAILED") << std::endl;
+		return failures == 0 ? 0 : 1;
+	}
+
+	/**
+	* Returns a slitherlink puzzle of the given size with all clues, whose loop surrounds a comb:
+	* a column of fields on the left with teeth reaching to the right in every second row.
+	*/
+	inline std::string combSlitherlink(int width, int height)
+	{
+		auto inside = [width, height](int x, int y) {
+			if (x < 1 || x > width - 2 || y < 1 || y > height - 2) return false;
+			return x == 1 || y % 2 == 1;
+		};
+		std::string result;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				bool in = inside(x, y);
+				int lines = (in != inside(x - 1, y)) + (in != inside(x + 1, y)) + (in != inside(x, y - 1)) + (in != inside(x, y + 1));
+				result += (char)('0' + lines);
+			}
+			result += '\n';
+		}
+		return result;
+	}
+}
+
+#define CHECK(condition) test::check((condition), #condition, __FILE__, __LINE__)